@@ -0,0 +1,166 @@
+#include "../src/LineKernels.hpp"
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <fmt/format.h>
+
+/*
+    Runs every SIMD line kernel the CPU has against the scalar one on random runs and checks they write
+    the same bytes. Positions that come out NaN only have to be NaN in both, since which operand's payload
+    survives an add isn't something the kernels promise.
+*/
+
+using LineKernels::LineRun;
+
+// written around every run so a kernel writing past count * 2 vertices shows up
+constexpr uint32_t GUARD = 0xabababab;
+constexpr size_t GUARD_VERTICES = 8;
+
+static float fromBits(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static uint32_t toBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+class RunGenerator {
+    std::mt19937 m_random;
+
+    template <typename T>
+    T pick(std::initializer_list<T> values) {
+        return values.begin()[std::uniform_int_distribution<size_t>(0, values.size() - 1)(m_random)];
+    }
+
+    float edgeFloat() {
+        using limits = std::numeric_limits<float>;
+        return pick<float>({
+            0.f, -0.f, 1.f, -1.f, 0.5f, 30.f, 1e-3f, 1e7f, 16777216.f, 16777217.f,
+            limits::denorm_min(), -limits::denorm_min(), fromBits(0x007fffff), limits::min(), -limits::min(),
+            limits::max(), limits::lowest(), limits::infinity(), -limits::infinity(),
+            limits::quiet_NaN(), -limits::quiet_NaN(), limits::signaling_NaN(), fromBits(0x7fc01234)
+        });
+    }
+
+    float randomFloat() {
+        switch (std::uniform_int_distribution<int>(0, 9)(m_random)) {
+            case 0: case 1: return edgeFloat();
+            // any bit pattern, NaNs and denormals included
+            case 2: return fromBits(m_random());
+            case 3: return fromBits(m_random() & 0x807fffff);
+            case 4: return std::uniform_real_distribution<float>(-1e-3f, 1e-3f)(m_random);
+            case 5: return std::uniform_real_distribution<float>(-1e9f, 1e9f)(m_random);
+            default: return std::uniform_real_distribution<float>(-1e5f, 1e5f)(m_random);
+        }
+    }
+
+    size_t randomCount() {
+        switch (std::uniform_int_distribution<int>(0, 3)(m_random)) {
+            case 0: return pick<size_t>({0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 1023, 1024});
+            case 1: return std::uniform_int_distribution<size_t>(0, 2000)(m_random);
+            default: return std::uniform_int_distribution<size_t>(0, 40)(m_random);
+        }
+    }
+
+    int randomFirst(size_t count) {
+        // first + count has to stay an int, the kernels don't widen the index
+        const int last = INT_MAX - static_cast<int>(count);
+        switch (std::uniform_int_distribution<int>(0, 5)(m_random)) {
+            case 0: return pick<int>({0, -1, 1, -static_cast<int>(count), INT_MIN, last, 16777215, -16777217});
+            case 1: return std::uniform_int_distribution<int>(INT_MIN, last)(m_random);
+            case 2: return std::uniform_int_distribution<int>(-1000, 0)(m_random);
+            default: return std::uniform_int_distribution<int>(-100000, 100000)(m_random);
+        }
+    }
+
+public:
+    explicit RunGenerator(uint32_t seed) : m_random(seed) {}
+
+    LineRun next() {
+        LineRun run;
+        run.origin = randomFloat();
+        run.step = randomFloat();
+        run.count = randomCount();
+        run.first = randomFirst(run.count);
+        run.from = randomFloat();
+        run.to = randomFloat();
+        run.colorA = m_random();
+        run.colorB = m_random();
+        run.vertical = m_random() & 1;
+        return run;
+    }
+};
+
+static std::vector<uint32_t> emitLanes(LineKernels::Kernel kernel, const LineRun& run) {
+    std::vector<Vertex> buffer(run.count * 2 + GUARD_VERTICES * 2);
+    std::memset(buffer.data(), 0xab, buffer.size() * sizeof(Vertex));
+    kernel(buffer.data() + GUARD_VERTICES, run);
+
+    std::vector<uint32_t> lanes(buffer.size() * 4);
+    std::memcpy(lanes.data(), buffer.data(), lanes.size() * sizeof(uint32_t));
+    return lanes;
+}
+
+static bool sameLane(uint32_t expected, uint32_t actual, size_t lane) {
+    if (expected == actual) return true;
+    // x and y, the color and padding lanes have to match exactly
+    if (lane % 4 > 1) return false;
+    return std::isnan(fromBits(expected)) && std::isnan(fromBits(actual));
+}
+
+// returns the first lane that differs, or npos
+static size_t compareRun(LineKernels::Kernel kernel, const LineRun& run, std::vector<uint32_t>& expected, std::vector<uint32_t>& actual) {
+    expected = emitLanes(LineKernels::emitScalar, run);
+    actual = emitLanes(kernel, run);
+
+    const size_t guardLanes = GUARD_VERTICES * 4;
+    for (size_t lane = 0; lane < actual.size(); ++lane) {
+        const bool guard = lane < guardLanes || lane >= actual.size() - guardLanes;
+        if (guard ? actual[lane] != GUARD : !sameLane(expected[lane], actual[lane], lane)) return lane;
+    }
+    return std::string::npos;
+}
+
+static void printFailure(const char* name, size_t index, const LineRun& run, size_t lane, const std::vector<uint32_t>& expected, const std::vector<uint32_t>& actual) {
+    fmt::print(stderr,
+        "{} differs from scalar on run {}: origin {:08x} step {:08x} first {} count {} from {:08x} to {:08x} {}\n"
+        "  vertex {} lane {}: expected {:08x}, got {:08x}\n",
+        name, index, toBits(run.origin), toBits(run.step), run.first, run.count, toBits(run.from), toBits(run.to),
+        run.vertical ? "vertical" : "horizontal",
+        static_cast<long>(lane / 4) - static_cast<long>(GUARD_VERTICES), lane % 4, expected[lane], actual[lane]);
+}
+
+int main(int argc, char** argv) {
+    const uint32_t seed = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 1;
+    const int runs = argc > 2 ? std::atoi(argv[2]) : 20000;
+
+    const auto kernels = LineKernels::getKernels();
+    int failures = 0;
+    std::vector<uint32_t> expected, actual;
+
+    for (const auto& choice : kernels) {
+        if (choice.kernel == LineKernels::emitScalar) continue;
+
+        RunGenerator generator(seed);
+        int kernelFailures = 0;
+        for (int i = 0; i < runs; ++i) {
+            const auto run = generator.next();
+            const size_t lane = compareRun(choice.kernel, run, expected, actual);
+            if (lane == std::string::npos) continue;
+            if (kernelFailures++ < 10) printFailure(choice.name, i, run, lane, expected, actual);
+        }
+
+        fmt::print("{}: {} runs, {} differ from scalar\n", choice.name, runs, kernelFailures);
+        failures += kernelFailures;
+    }
+
+    if (kernels.size() == 1) fmt::print("only the scalar kernel runs on this CPU, nothing to compare\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,187 @@
+#include "SyntheticLevel.hpp"
+#include <random>
+
+using namespace geode::prelude;
+
+static constexpr float GRID_SIZE = 30.f;
+static constexpr float FLOOR_Y = 105.f;
+static constexpr int ROWS = 100;
+// a song marker every half a second at normal speed
+static constexpr float MARKER_SPACING = 155.79f;
+static constexpr size_t TRIGGERS_PER_GUIDE = 50;
+// BPM guides follow each other, each one covering its stretch of the level
+static constexpr float UNITS_PER_AUDIO_LINE = 3000.f;
+
+struct TriggerKind {
+    int objectID;
+    // out of the sum of all weights
+    int weight;
+};
+
+// move, pulse, SFX, alpha, rotate, follow and spawn, roughly how often they show up in big levels
+static constexpr TriggerKind TRIGGER_KINDS[] = {
+    {901, 40},
+    {1006, 15},
+    {3602, 5},
+    {1007, 15},
+    {1346, 10},
+    {1347, 5},
+    {1268, 10},
+};
+
+static EffectGameObject* createTrigger(std::mt19937& random, float length) {
+    static std::discrete_distribution<int> kind = [] {
+        std::vector<int> weights;
+        for (const auto& triggerKind : TRIGGER_KINDS) weights.push_back(triggerKind.weight);
+        return std::discrete_distribution<int>(weights.begin(), weights.end());
+    }();
+    std::uniform_real_distribution<float> x(0, length);
+    std::uniform_int_distribution<int> row(0, ROWS - 1);
+    std::uniform_real_distribution<float> duration(0, 2);
+    std::uniform_real_distribution<float> chance(0, 1);
+
+    const int objectID = TRIGGER_KINDS[kind(random)].objectID;
+    EffectGameObject* trigger = objectID == 3602 ? new SFXTriggerGameObject() : new EffectGameObject();
+    trigger->m_objectID = objectID;
+    trigger->m_objectType = GameObjectType::Modifier;
+    // on the grid like the editor would place them
+    trigger->setPosition({std::floor(x(random) / GRID_SIZE) * GRID_SIZE + GRID_SIZE * 0.5f, FLOOR_Y + row(random) * GRID_SIZE});
+    trigger->m_isSpawnTriggered = chance(random) < 0.3f;
+    trigger->m_isTouchTriggered = !trigger->m_isSpawnTriggered && chance(random) < 0.05f;
+
+    switch (objectID) {
+        case 1006:
+            trigger->m_fadeInDuration = duration(random) * 0.25f;
+            trigger->m_holdDuration = duration(random) * 0.5f;
+            trigger->m_fadeOutDuration = duration(random) * 0.25f;
+            break;
+        case 3602:
+            static_cast<SFXTriggerGameObject*>(trigger)->m_soundDuration = duration(random);
+            break;
+        case 1268:
+            break;
+        default:
+            trigger->m_duration = chance(random) < 0.2f ? 0 : duration(random);
+            break;
+    }
+    return trigger;
+}
+
+static bool hasDuration(EffectGameObject* trigger) {
+    switch (trigger->m_objectID) {
+        case 1006: return trigger->m_fadeInDuration + trigger->m_holdDuration + trigger->m_fadeOutDuration > 0;
+        case 3602: return static_cast<SFXTriggerGameObject*>(trigger)->m_soundDuration > 0;
+        default: return trigger->m_duration > 0;
+    }
+}
+
+static GameObject* createGuide(std::mt19937& random, float length) {
+    static constexpr GameObjectType PORTALS[] = {GameObjectType::ShipPortal, GameObjectType::BallPortal, GameObjectType::UfoPortal, GameObjectType::WavePortal, GameObjectType::SpiderPortal};
+    std::uniform_real_distribution<float> x(0, length);
+    std::uniform_int_distribution<int> row(0, 10);
+    std::uniform_int_distribution<size_t> portal(0, std::size(PORTALS) - 1);
+
+    auto guide = new GameObject();
+    guide->m_objectType = PORTALS[portal(random)];
+    guide->setPosition({std::floor(x(random) / GRID_SIZE) * GRID_SIZE + GRID_SIZE * 0.5f, FLOOR_Y + row(random) * GRID_SIZE});
+    return guide;
+}
+
+SyntheticLevel::SyntheticLevel(const SyntheticLevelOptions& options) {
+    std::mt19937 random(options.seed);
+    m_length = std::max(options.triggers * options.spacing, 10000.f);
+
+    auto editorLayer = new LevelEditorLayer();
+    auto drawGridLayer = new DrawGridLayer();
+    m_editorLayer = editorLayer;
+    m_drawGridLayer = drawGridLayer;
+    editorLayer->release();
+    drawGridLayer->release();
+
+    editorLayer->m_objectLayer = new CCLayer();
+    editorLayer->addChild(editorLayer->m_objectLayer);
+    editorLayer->m_objectLayer->addChild(drawGridLayer);
+    editorLayer->m_objectLayer->release();
+    editorLayer->m_drawGridLayer = drawGridLayer;
+    drawGridLayer->m_editorLayer = editorLayer;
+    drawGridLayer->setContentSize(CCDirector::get()->getWinSize());
+
+    editorLayer->m_levelSettings = new LevelSettingsObject();
+    editorLayer->m_player1 = new PlayerObject();
+    editorLayer->m_editorUI = new EditorUI();
+    editorLayer->m_editorUI->m_selectedObjects = new CCArray();
+    editorLayer->m_objects = new CCArray();
+    editorLayer->m_undoObjects = new CCArray();
+    editorLayer->m_redoObjects = new CCArray();
+    editorLayer->m_durationObjects = new CCArray();
+    drawGridLayer->m_effectGameObjects = new CCArray();
+    drawGridLayer->m_guideObjects = new CCArray();
+    drawGridLayer->m_speedObjects = new CCArray();
+    drawGridLayer->m_timeMarkers = new CCArray();
+
+    std::bernoulli_distribution selected(options.selected);
+    for (size_t i = 0; i < options.triggers; ++i) {
+        auto trigger = createTrigger(random, m_length);
+        editorLayer->m_objects->addObject(trigger);
+        drawGridLayer->m_effectGameObjects->addObject(trigger);
+        if (hasDuration(trigger)) editorLayer->m_durationObjects->addObject(trigger);
+        if (selected(random)) {
+            trigger->m_isSelected = true;
+            editorLayer->m_editorUI->m_selectedObjects->addObject(trigger);
+        }
+        trigger->release();
+    }
+
+    for (size_t i = 0; i < std::max<size_t>(options.triggers / TRIGGERS_PER_GUIDE, 1); ++i) {
+        auto guide = createGuide(random, m_length);
+        editorLayer->m_objects->addObject(guide);
+        drawGridLayer->m_guideObjects->addObject(guide);
+        guide->release();
+    }
+
+    // markers come in pairs of position and type, like the game keeps them
+    static constexpr const char* MARKER_TYPES[] = {"0.9", "1", "0.8"};
+    const size_t markers = static_cast<size_t>(m_length / MARKER_SPACING);
+    for (size_t i = 0; i < markers; ++i) {
+        drawGridLayer->m_timeMarkers->addObject(CCString::create(fmt::format("{}", i * MARKER_SPACING)));
+        drawGridLayer->m_timeMarkers->addObject(CCString::create(MARKER_TYPES[i % std::size(MARKER_TYPES)]));
+    }
+
+    const size_t audioLines = std::max<size_t>(static_cast<size_t>(m_length / UNITS_PER_AUDIO_LINE), 1);
+    const float audioLineLength = m_length / audioLines;
+    for (size_t i = 0; i < audioLines; ++i) {
+        auto audioLine = new AudioLineGuideGameObject();
+        audioLine->m_objectID = 3642;
+        audioLine->setPosition({audioLineLength * i, FLOOR_Y});
+        // in seconds, the guides are at normal speed
+        audioLine->m_duration = audioLineLength / drawGridLayer->m_normalSpeed;
+        audioLine->m_beatsPerMinute = 100.f + 10.f * (i % 8);
+        editorLayer->m_objects->addObject(audioLine);
+        drawGridLayer->m_audioLineObjects[static_cast<int>(i)] = audioLine;
+        audioLine->release();
+    }
+
+    CCPoolManager::sharedPoolManager()->pop();
+    lookAt({m_length * 0.5f, FLOOR_Y + ROWS * GRID_SIZE * 0.25f}, 1);
+}
+
+SyntheticLevel::~SyntheticLevel() {
+    auto editorLayer = m_editorLayer.data();
+    auto drawGridLayer = m_drawGridLayer.data();
+    if (LevelEditorLayer::get() == editorLayer) LevelEditorLayer::setCurrent(nullptr);
+
+    for (CCObject* object : std::initializer_list<CCObject*>{
+        editorLayer->m_levelSettings, editorLayer->m_player1, editorLayer->m_editorUI->m_selectedObjects, editorLayer->m_editorUI,
+        editorLayer->m_objects, editorLayer->m_undoObjects, editorLayer->m_redoObjects, editorLayer->m_durationObjects,
+        drawGridLayer->m_effectGameObjects, drawGridLayer->m_guideObjects, drawGridLayer->m_speedObjects, drawGridLayer->m_timeMarkers
+    }) {
+        object->release();
+    }
+}
+
+void SyntheticLevel::lookAt(const CCPoint& point, float zoom) {
+    const CCSize winSize = CCDirector::get()->getWinSize();
+    auto objectLayer = m_editorLayer->m_objectLayer;
+    objectLayer->setScale(zoom);
+    objectLayer->setPosition(CCPoint{winSize.width * 0.5f, winSize.height * 0.5f} - point * zoom);
+}
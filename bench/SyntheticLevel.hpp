@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Geode/Geode.hpp>
+#include <cstddef>
+#include <cstdint>
+
+struct SyntheticLevelOptions {
+    size_t triggers = 1000;
+    // level units per trigger along x, so views see about as many triggers at every level size
+    float spacing = 4.f;
+    // share of the triggers placed in the selection
+    float selected = 0.01f;
+    uint32_t seed = 1;
+};
+
+/*
+    An editor with a level made up on the spot: effect triggers with durations, guide portals, time markers
+    and audio line guides, laid out the way a large real level would be. The same options always give the
+    same level, so runs can be compared against each other.
+*/
+class SyntheticLevel {
+    geode::Ref<LevelEditorLayer> m_editorLayer;
+    geode::Ref<DrawGridLayer> m_drawGridLayer;
+    float m_length = 0;
+
+public:
+    explicit SyntheticLevel(const SyntheticLevelOptions& options);
+    ~SyntheticLevel();
+
+    SyntheticLevel(const SyntheticLevel&) = delete;
+    SyntheticLevel& operator=(const SyntheticLevel&) = delete;
+
+    LevelEditorLayer* getEditorLayer() const {
+        return m_editorLayer;
+    }
+
+    DrawGridLayer* getDrawGridLayer() const {
+        return m_drawGridLayer;
+    }
+
+    float getLength() const {
+        return m_length;
+    }
+
+    // puts the middle of the window over this point of the level
+    void lookAt(const cocos2d::CCPoint& point, float zoom);
+};
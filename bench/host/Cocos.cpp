@@ -0,0 +1,401 @@
+#include <Geode/Geode.hpp>
+#include <cstring>
+
+using namespace geode::prelude;
+
+// column major like kazmath
+static kmMat4 identity() {
+    kmMat4 matrix{};
+    matrix.mat[0] = matrix.mat[5] = matrix.mat[10] = matrix.mat[15] = 1;
+    return matrix;
+}
+
+static kmMat4 multiply(const kmMat4& a, const kmMat4& b) {
+    kmMat4 result{};
+    for (int column = 0; column < 4; ++column) {
+        for (int row = 0; row < 4; ++row) {
+            float sum = 0;
+            for (int i = 0; i < 4; ++i) sum += a.mat[i * 4 + row] * b.mat[column * 4 + i];
+            result.mat[column * 4 + row] = sum;
+        }
+    }
+    return result;
+}
+
+static std::vector<kmMat4> modelviewStack{identity()};
+static std::vector<kmMat4> projectionStack{identity()};
+static std::vector<kmMat4>* currentStack = &modelviewStack;
+
+void kmGLMatrixMode(unsigned mode) {
+    currentStack = mode == KM_GL_PROJECTION ? &projectionStack : &modelviewStack;
+}
+
+void kmGLPushMatrix() {
+    currentStack->push_back(currentStack->back());
+}
+
+void kmGLPopMatrix() {
+    if (currentStack->size() > 1) currentStack->pop_back();
+}
+
+void kmGLLoadIdentity() {
+    currentStack->back() = identity();
+}
+
+void kmGLMultMatrix(const kmMat4* matrix) {
+    currentStack->back() = multiply(currentStack->back(), *matrix);
+}
+
+void kmGLTranslatef(float x, float y, float z) {
+    kmMat4 translation = identity();
+    translation.mat[12] = x;
+    translation.mat[13] = y;
+    translation.mat[14] = z;
+    kmGLMultMatrix(&translation);
+}
+
+// only ever turned around the z axis
+void kmGLRotatef(float angle, float, float, float) {
+    const float radians = CC_DEGREES_TO_RADIANS(angle);
+    kmMat4 rotation = identity();
+    rotation.mat[0] = std::cos(radians);
+    rotation.mat[1] = std::sin(radians);
+    rotation.mat[4] = -std::sin(radians);
+    rotation.mat[5] = std::cos(radians);
+    kmGLMultMatrix(&rotation);
+}
+
+void kmGLScalef(float x, float y, float z) {
+    kmMat4 scale = identity();
+    scale.mat[0] = x;
+    scale.mat[5] = y;
+    scale.mat[10] = z;
+    kmGLMultMatrix(&scale);
+}
+
+void kmGLGetMatrix(unsigned mode, kmMat4* matrix) {
+    *matrix = mode == KM_GL_PROJECTION ? projectionStack.back() : modelviewStack.back();
+}
+
+static kmMat4 orthographic(float width, float height) {
+    kmMat4 matrix = identity();
+    matrix.mat[0] = 2 / width;
+    matrix.mat[5] = 2 / height;
+    matrix.mat[10] = -1;
+    matrix.mat[12] = -1;
+    matrix.mat[13] = -1;
+    return matrix;
+}
+
+namespace cocos2d {
+    void CGAffineToGL(const CCAffineTransform* t, GLfloat* m) {
+        std::memset(m, 0, sizeof(GLfloat) * 16);
+        m[0] = t->a;
+        m[1] = t->b;
+        m[4] = t->c;
+        m[5] = t->d;
+        m[10] = 1;
+        m[12] = t->tx;
+        m[13] = t->ty;
+        m[15] = 1;
+    }
+
+    void ccGLUseProgram(GLuint program) {
+        glUseProgram(program);
+    }
+
+    void ccGLDeleteProgram(GLuint program) {
+        glDeleteProgram(program);
+    }
+
+    void ccGLBlendFunc(GLenum sfactor, GLenum dfactor) {
+        if (sfactor == GL_ONE && dfactor == GL_ZERO) {
+            glDisable(GL_BLEND);
+            return;
+        }
+        glEnable(GL_BLEND);
+        glBlendFunc(sfactor, dfactor);
+    }
+
+    void ccGLEnableVertexAttribs(unsigned int flags) {
+        for (GLuint attribute = 0; attribute < kCCVertexAttrib_MAX; ++attribute) {
+            if (flags & (1 << attribute)) glEnableVertexAttribArray(attribute);
+            else glDisableVertexAttribArray(attribute);
+        }
+    }
+
+    void ccGLBindTexture2D(GLuint textureId) {
+        ccGLBindTexture2DN(0, textureId);
+    }
+
+    void ccGLBindTexture2DN(GLuint textureUnit, GLuint textureId) {
+        glActiveTexture(GL_TEXTURE0 + textureUnit);
+        glBindTexture(GL_TEXTURE_2D, textureId);
+    }
+
+    void ccGLDeleteTexture(GLuint textureId) {
+        glDeleteTextures(1, &textureId);
+    }
+
+    static constexpr const char* SHADER_PREAMBLE =
+        "#define lowp\n"
+        "#define mediump\n"
+        "#define highp\n"
+        "uniform mat4 CC_PMatrix;\n"
+        "uniform mat4 CC_MVMatrix;\n"
+        "uniform mat4 CC_MVPMatrix;\n";
+
+    static GLuint compileShader(GLenum type, const GLchar* source) {
+        const GLchar* sources[] = {SHADER_PREAMBLE, source};
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 2, sources, nullptr);
+        glCompileShader(shader);
+
+        GLint status = GL_FALSE;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+        if (!status) {
+            GLchar message[1024];
+            glGetShaderInfoLog(shader, sizeof(message), nullptr, message);
+            log::error("Shader failed to compile: {}", message);
+            glDeleteShader(shader);
+            return 0;
+        }
+        return shader;
+    }
+
+    CCGLProgram::~CCGLProgram() {
+        if (m_program) glDeleteProgram(m_program);
+    }
+
+    bool CCGLProgram::initWithVertexShaderByteArray(const GLchar* vShaderByteArray, const GLchar* fShaderByteArray) {
+        m_vertShader = compileShader(GL_VERTEX_SHADER, vShaderByteArray);
+        m_fragShader = compileShader(GL_FRAGMENT_SHADER, fShaderByteArray);
+        if (!m_vertShader || !m_fragShader) return false;
+
+        m_program = glCreateProgram();
+        glAttachShader(m_program, m_vertShader);
+        glAttachShader(m_program, m_fragShader);
+        return true;
+    }
+
+    void CCGLProgram::addAttribute(const char* attributeName, GLuint index) {
+        glBindAttribLocation(m_program, index, attributeName);
+    }
+
+    bool CCGLProgram::link() {
+        glLinkProgram(m_program);
+        glDeleteShader(m_vertShader);
+        glDeleteShader(m_fragShader);
+        m_vertShader = m_fragShader = 0;
+
+        GLint status = GL_FALSE;
+        glGetProgramiv(m_program, GL_LINK_STATUS, &status);
+        if (!status) {
+            GLchar message[1024];
+            glGetProgramInfoLog(m_program, sizeof(message), nullptr, message);
+            log::error("Program failed to link: {}", message);
+            return false;
+        }
+        return true;
+    }
+
+    void CCGLProgram::use() {
+        ccGLUseProgram(m_program);
+    }
+
+    void CCGLProgram::updateUniforms() {
+        m_uniforms[kCCUniformPMatrix] = glGetUniformLocation(m_program, "CC_PMatrix");
+        m_uniforms[kCCUniformMVMatrix] = glGetUniformLocation(m_program, "CC_MVMatrix");
+        m_uniforms[kCCUniformMVPMatrix] = glGetUniformLocation(m_program, "CC_MVPMatrix");
+    }
+
+    void CCGLProgram::setUniformsForBuiltins() {
+        kmMat4 projection, modelview;
+        kmGLGetMatrix(KM_GL_PROJECTION, &projection);
+        kmGLGetMatrix(KM_GL_MODELVIEW, &modelview);
+        const kmMat4 modelviewProjection = multiply(projection, modelview);
+
+        glUniformMatrix4fv(m_uniforms[kCCUniformPMatrix], 1, GL_FALSE, projection.mat);
+        glUniformMatrix4fv(m_uniforms[kCCUniformMVMatrix], 1, GL_FALSE, modelview.mat);
+        glUniformMatrix4fv(m_uniforms[kCCUniformMVPMatrix], 1, GL_FALSE, modelviewProjection.mat);
+    }
+
+    GLint CCGLProgram::getUniformLocationForName(const char* name) {
+        return glGetUniformLocation(m_program, name);
+    }
+
+    void CCGLProgram::setUniformLocationWith1i(GLint location, GLint i1) {
+        glUniform1i(location, i1);
+    }
+
+    void CCGLProgram::setUniformLocationWith1f(GLint location, GLfloat f1) {
+        glUniform1f(location, f1);
+    }
+
+    void CCGLProgram::setUniformLocationWith2f(GLint location, GLfloat f1, GLfloat f2) {
+        glUniform2f(location, f1, f2);
+    }
+
+    void CCGLProgram::setUniformLocationWith4f(GLint location, GLfloat f1, GLfloat f2, GLfloat f3, GLfloat f4) {
+        glUniform4f(location, f1, f2, f3, f4);
+    }
+
+    static constexpr const char* POSITION_COLOR_VERTEX = R"(
+attribute vec4 a_position;
+attribute vec4 a_color;
+varying lowp vec4 v_fragmentColor;
+
+void main() {
+    gl_Position = CC_MVPMatrix * a_position;
+    v_fragmentColor = a_color;
+}
+)";
+
+    static constexpr const char* POSITION_COLOR_FRAGMENT = R"(
+varying lowp vec4 v_fragmentColor;
+
+void main() {
+    gl_FragColor = v_fragmentColor;
+}
+)";
+
+    static constexpr const char* POSITION_TEXTURE_VERTEX = R"(
+attribute vec4 a_position;
+attribute vec2 a_texCoord;
+varying mediump vec2 v_texCoord;
+
+void main() {
+    gl_Position = CC_MVPMatrix * a_position;
+    v_texCoord = a_texCoord;
+}
+)";
+
+    static constexpr const char* POSITION_TEXTURE_FRAGMENT = R"(
+varying mediump vec2 v_texCoord;
+uniform sampler2D CC_Texture0;
+
+void main() {
+    gl_FragColor = texture2D(CC_Texture0, v_texCoord);
+}
+)";
+
+    void CCShaderCache::loadDefaultShaders() {
+        struct Default {
+            const char* key;
+            const char* vertex;
+            const char* fragment;
+            bool textured;
+        };
+        static constexpr Default defaults[] = {
+            {kCCShader_PositionColor, POSITION_COLOR_VERTEX, POSITION_COLOR_FRAGMENT, false},
+            {kCCShader_PositionTexture, POSITION_TEXTURE_VERTEX, POSITION_TEXTURE_FRAGMENT, true},
+        };
+
+        for (const auto& shader : defaults) {
+            auto program = new CCGLProgram();
+            if (program->initWithVertexShaderByteArray(shader.vertex, shader.fragment)) {
+                program->addAttribute(kCCAttributeNamePosition, kCCVertexAttrib_Position);
+                if (shader.textured) program->addAttribute(kCCAttributeNameTexCoord, kCCVertexAttrib_TexCoords);
+                else program->addAttribute(kCCAttributeNameColor, kCCVertexAttrib_Color);
+                if (program->link()) {
+                    program->updateUniforms();
+                    if (shader.textured) {
+                        program->use();
+                        program->setUniformLocationWith1i(program->getUniformLocationForName("CC_Texture0"), 0);
+                    }
+                    addProgram(program, shader.key);
+                }
+            }
+            program->release();
+        }
+    }
+
+    bool CCConfiguration::checkForGLExtension(const std::string& searchName) const {
+        auto extensions = reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+        return extensions && std::strstr(extensions, searchName.c_str());
+    }
+
+    CCTexture2D::CCTexture2D(int width, int height) {
+        glGenTextures(1, &m_name);
+        ccGLBindTexture2D(m_name);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+    CCTexture2D::~CCTexture2D() {
+        ccGLDeleteTexture(m_name);
+    }
+
+    void CCTexture2D::setAliasTexParameters() {
+        ccGLBindTexture2D(m_name);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+
+    CCRenderTexture::~CCRenderTexture() {
+        if (m_fbo) glDeleteFramebuffers(1, &m_fbo);
+    }
+
+    CCRenderTexture* CCRenderTexture::create(int width, int height) {
+        if (width <= 0 || height <= 0) return nullptr;
+
+        auto texture = new CCTexture2D(width, height);
+        auto renderTexture = new CCRenderTexture();
+        renderTexture->m_sprite = new CCSprite(texture);
+        renderTexture->m_sprite->release();
+        texture->release();
+        renderTexture->m_width = width;
+        renderTexture->m_height = height;
+
+        GLint oldFBO;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &oldFBO);
+        glGenFramebuffers(1, &renderTexture->m_fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, renderTexture->m_fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, renderTexture->m_sprite->getTexture()->getName(), 0);
+        const bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, oldFBO);
+
+        if (!complete) {
+            renderTexture->release();
+            return nullptr;
+        }
+        renderTexture->autorelease();
+        return renderTexture;
+    }
+
+    void CCRenderTexture::begin() {
+        const CCSize winSize = CCDirector::get()->getWinSize();
+
+        kmGLMatrixMode(KM_GL_PROJECTION);
+        kmGLPushMatrix();
+        const kmMat4 projection = orthographic(winSize.width, winSize.height);
+        kmGLLoadIdentity();
+        kmGLMultMatrix(&projection);
+        kmGLMatrixMode(KM_GL_MODELVIEW);
+        kmGLPushMatrix();
+
+        glGetIntegerv(GL_VIEWPORT, m_oldViewport);
+        glViewport(0, 0, m_width, m_height);
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &m_oldFBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    }
+
+    void CCRenderTexture::beginWithClear(float r, float g, float b, float a) {
+        begin();
+        glClearColor(r, g, b, a);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+
+    void CCRenderTexture::end() {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_oldFBO);
+        glViewport(m_oldViewport[0], m_oldViewport[1], m_oldViewport[2], m_oldViewport[3]);
+
+        kmGLMatrixMode(KM_GL_PROJECTION);
+        kmGLPopMatrix();
+        kmGLMatrixMode(KM_GL_MODELVIEW);
+        kmGLPopMatrix();
+    }
+}
@@ -0,0 +1,99 @@
+#include <HostGL.h>
+#include <cstring>
+
+// nothing is drawn, only enough happens for the callers to carry on: names are handed out and reads come back zeroed
+
+static GLuint nextName = 1;
+
+static void generate(GLsizei n, GLuint* names) {
+    for (GLsizei i = 0; i < n; ++i) names[i] = nextName++;
+}
+
+extern "C" {
+
+void glActiveTexture(GLenum) {}
+void glAttachShader(GLuint, GLuint) {}
+void glBeginQuery(GLenum, GLuint) {}
+void glBindAttribLocation(GLuint, GLuint, const GLchar*) {}
+void glBindBuffer(GLenum, GLuint) {}
+void glBindFramebuffer(GLenum, GLuint) {}
+void glBindTexture(GLenum, GLuint) {}
+void glBlendFunc(GLenum, GLenum) {}
+void glBufferData(GLenum, GLsizeiptr, const void*, GLenum) {}
+GLenum glCheckFramebufferStatus(GLenum) { return GL_FRAMEBUFFER_COMPLETE; }
+void glClear(GLbitfield) {}
+void glClearColor(GLfloat, GLfloat, GLfloat, GLfloat) {}
+void glCompileShader(GLuint) {}
+GLuint glCreateProgram() { return nextName++; }
+GLuint glCreateShader(GLenum) { return nextName++; }
+void glDeleteBuffers(GLsizei, const GLuint*) {}
+void glDeleteFramebuffers(GLsizei, const GLuint*) {}
+void glDeleteProgram(GLuint) {}
+void glDeleteQueries(GLsizei, const GLuint*) {}
+void glDeleteShader(GLuint) {}
+void glDeleteTextures(GLsizei, const GLuint*) {}
+void glDisable(GLenum) {}
+void glDisableVertexAttribArray(GLuint) {}
+void glDrawArrays(GLenum, GLint, GLsizei) {}
+void glEnable(GLenum) {}
+void glEnableVertexAttribArray(GLuint) {}
+void glEndQuery(GLenum) {}
+void glFinish() {}
+void glFramebufferTexture2D(GLenum, GLenum, GLenum, GLuint, GLint) {}
+void glGenBuffers(GLsizei n, GLuint* buffers) { generate(n, buffers); }
+void glGenFramebuffers(GLsizei n, GLuint* framebuffers) { generate(n, framebuffers); }
+void glGenQueries(GLsizei n, GLuint* ids) { generate(n, ids); }
+void glGenTextures(GLsizei n, GLuint* textures) { generate(n, textures); }
+
+void glGetIntegerv(GLenum pname, GLint* data) {
+    *data = 0;
+    if (pname == GL_VIEWPORT) std::memset(data, 0, sizeof(GLint) * 4);
+}
+
+void glGetProgramInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog) {
+    if (length) *length = 0;
+    if (bufSize > 0) infoLog[0] = 0;
+}
+
+void glGetProgramiv(GLuint, GLenum, GLint* params) { *params = GL_TRUE; }
+void glGetQueryObjectiv(GLuint, GLenum, GLint* params) { *params = 0; }
+void glGetQueryObjectui64v(GLuint, GLenum, GLuint64* params) { *params = 0; }
+
+void glGetShaderInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog) {
+    if (length) *length = 0;
+    if (bufSize > 0) infoLog[0] = 0;
+}
+
+void glGetShaderiv(GLuint, GLenum, GLint* params) { *params = GL_TRUE; }
+
+// old enough that the GPU timers stay off
+const GLubyte* glGetString(GLenum name) {
+    static const GLubyte version[] = "2.0 host stub";
+    static const GLubyte empty[] = "";
+    return name == GL_VERSION ? version : empty;
+}
+
+GLint glGetUniformLocation(GLuint, const GLchar*) { return -1; }
+void glHint(GLenum, GLenum) {}
+void glLineWidth(GLfloat) {}
+void glLinkProgram(GLuint) {}
+void glPixelStorei(GLenum, GLint) {}
+
+void glReadPixels(GLint, GLint, GLsizei width, GLsizei height, GLenum, GLenum, void* pixels) {
+    std::memset(pixels, 0, static_cast<size_t>(width) * height * 4);
+}
+
+void glShaderSource(GLuint, GLsizei, const GLchar* const*, const GLint*) {}
+void glTexImage2D(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const void*) {}
+void glTexParameteri(GLenum, GLenum, GLint) {}
+void glTexSubImage2D(GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, const void*) {}
+void glUniform1f(GLint, GLfloat) {}
+void glUniform1i(GLint, GLint) {}
+void glUniform2f(GLint, GLfloat, GLfloat) {}
+void glUniform4f(GLint, GLfloat, GLfloat, GLfloat, GLfloat) {}
+void glUniformMatrix4fv(GLint, GLsizei, GLboolean, const GLfloat*) {}
+void glUseProgram(GLuint) {}
+void glVertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void*) {}
+void glViewport(GLint, GLint, GLsizei, GLsizei) {}
+
+}
@@ -0,0 +1,87 @@
+#include "OffscreenContext.hpp"
+#include <vector>
+
+#ifdef GOOD_GRID_OSMESA
+
+#include <GL/osmesa.h>
+
+struct OffscreenContext::Impl {
+    OSMesaContext m_context = nullptr;
+    std::vector<unsigned char> m_buffer;
+
+    ~Impl() {
+        if (m_context) OSMesaDestroyContext(m_context);
+    }
+};
+
+bool OffscreenContext::create(int width, int height, std::string& error) {
+    m_impl->m_context = OSMesaCreateContextExt(OSMESA_RGBA, 24, 8, 0, nullptr);
+    if (!m_impl->m_context) {
+        error = "OSMesaCreateContextExt failed";
+        return false;
+    }
+
+    m_impl->m_buffer.resize(static_cast<size_t>(width) * height * 4);
+    if (!OSMesaMakeCurrent(m_impl->m_context, m_impl->m_buffer.data(), GL_UNSIGNED_BYTE, width, height)) {
+        error = "OSMesaMakeCurrent failed";
+        return false;
+    }
+    return true;
+}
+
+#else
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+struct OffscreenContext::Impl {
+    EGLDisplay m_display = EGL_NO_DISPLAY;
+    EGLContext m_context = EGL_NO_CONTEXT;
+
+    ~Impl() {
+        if (m_display == EGL_NO_DISPLAY) return;
+        eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (m_context != EGL_NO_CONTEXT) eglDestroyContext(m_display, m_context);
+        eglTerminate(m_display);
+    }
+};
+
+bool OffscreenContext::create(int, int, std::string& error) {
+    auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (!getPlatformDisplay) {
+        error = "EGL_EXT_platform_base isn't supported";
+        return false;
+    }
+    m_impl->m_display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (m_impl->m_display == EGL_NO_DISPLAY || !eglInitialize(m_impl->m_display, nullptr, nullptr)) {
+        m_impl->m_display = EGL_NO_DISPLAY;
+        error = "No surfaceless EGL display";
+        return false;
+    }
+
+    // compatibility, cocos draws from client side arrays
+    const EGLint attributes[] = {
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT,
+        EGL_NONE
+    };
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        error = "EGL can't create desktop GL contexts";
+        return false;
+    }
+    m_impl->m_context = eglCreateContext(m_impl->m_display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attributes);
+    if (m_impl->m_context == EGL_NO_CONTEXT) {
+        error = "eglCreateContext failed";
+        return false;
+    }
+    if (!eglMakeCurrent(m_impl->m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, m_impl->m_context)) {
+        error = "eglMakeCurrent failed";
+        return false;
+    }
+    return true;
+}
+
+#endif
+
+OffscreenContext::OffscreenContext() : m_impl(std::make_unique<Impl>()) {}
+
+OffscreenContext::~OffscreenContext() = default;
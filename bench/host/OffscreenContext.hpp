@@ -0,0 +1,24 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+/*
+    Makes a GL context current without a window, through OSMesa when the bench is built against it and
+    through EGL's surfaceless platform otherwise. Without a GPU both end up in Mesa's software rasterizers,
+    so checksums stay comparable between runs on the same machine.
+*/
+class OffscreenContext {
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+
+public:
+    OffscreenContext();
+    ~OffscreenContext();
+
+    OffscreenContext(const OffscreenContext&) = delete;
+    OffscreenContext& operator=(const OffscreenContext&) = delete;
+
+    // the size only matters to OSMesa, which needs a buffer to draw into even when nothing is drawn to it
+    bool create(int width, int height, std::string& error);
+};
@@ -0,0 +1,172 @@
+#include "../include/DrawGridAPI.hpp"
+#include "SyntheticLevel.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <fmt/format.h>
+
+#ifdef GOOD_GRID_HOST_GL
+#include "host/OffscreenContext.hpp"
+#endif
+
+using namespace geode::prelude;
+
+struct BenchOptions {
+    std::vector<size_t> sizes = {1000, 10000, 100000, 1000000};
+    int iterations = 10;
+    // draw() called as the editor would, the level's full frame instead of one node at a time
+    int frames = 30;
+    bool nodes = false;
+    // runRenderBenchmark iterations, only good-grid-render-bench has anything to render with
+    int render = 0;
+    int width = 1024;
+};
+
+static void usage() {
+    fmt::print(stderr,
+        "usage: good-grid-bench [options]\n"
+        "  --sizes 1000,10000,...   trigger counts of the levels to generate\n"
+        "  --iterations n           runBenchmark iterations per view\n"
+        "  --frames n               full draw() frames timed per level\n"
+        "  --nodes                  prints every node's timings, not just the whole view's\n"
+        "  --set name=value         sets one of mod.json's settings, like --set parallel-draw=true\n"
+        "  --render n               runRenderBenchmark iterations per scenario, good-grid-render-bench only\n"
+        "  --width n                width of the rendered frames in pixels\n"
+    );
+}
+
+static std::vector<size_t> parseSizes(std::string_view text) {
+    std::vector<size_t> sizes;
+    while (!text.empty()) {
+        const auto comma = std::min(text.find(','), text.size());
+        if (auto size = numFromString<size_t>(text.substr(0, comma))) sizes.push_back(size.unwrap());
+        text.remove_prefix(std::min(comma + 1, text.size()));
+    }
+    return sizes;
+}
+
+static void setSetting(const std::string& assignment) {
+    const auto equals = assignment.find('=');
+    if (equals == std::string::npos) return;
+    const auto key = assignment.substr(0, equals);
+    const auto value = assignment.substr(equals + 1);
+
+    if (value == "true" || value == "false") Mod::get()->setSettingValue(key, value == "true");
+    else if (auto number = numFromString<int64_t>(value)) Mod::get()->setSettingValue(key, number.unwrap());
+    else Mod::get()->setSettingValue(key, value);
+}
+
+// the defaults from mod.json, the ones that aren't false or zero
+static void setDefaultSettings() {
+    Mod::get()->setSettingValue("column-aggregation", std::string("Off"));
+    Mod::get()->setSettingValue<int64_t>("memory-budget", 64);
+    Mod::get()->setSettingValue("optimize-geometry", true);
+}
+
+static void benchmarkFrames(DrawGridAPI& api, int frames) {
+    std::vector<float> frameMs;
+    for (int i = 0; i < frames; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        api.draw();
+        const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        frameMs.push_back(elapsed.count());
+    }
+    if (frameMs.empty()) return;
+
+    std::sort(frameMs.begin(), frameMs.end());
+    const auto timings = api.getFrameTimings();
+    fmt::print("  draw(): {:.3f}ms avg, {:.3f}ms median, {:.3f}ms worst, last frame {:.3f}ms generating and {:.3f}ms submitting\n",
+        std::accumulate(frameMs.begin(), frameMs.end(), 0.f) / frameMs.size(), frameMs[frameMs.size() / 2], frameMs.back(),
+        timings.generateMs, timings.submitMs);
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    setDefaultSettings();
+
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--sizes") && hasValue) options.sizes = parseSizes(argv[++i]);
+        else if (!std::strcmp(argv[i], "--iterations") && hasValue) options.iterations = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--frames") && hasValue) options.frames = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--set") && hasValue) setSetting(argv[++i]);
+        else if (!std::strcmp(argv[i], "--nodes")) options.nodes = true;
+        else if (!std::strcmp(argv[i], "--render") && hasValue) options.render = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--width") && hasValue) options.width = std::atoi(argv[++i]);
+        else {
+            usage();
+            return 2;
+        }
+    }
+
+#ifdef GOOD_GRID_HOST_GL
+    OffscreenContext context;
+    std::string error;
+    if (!context.create(options.width, options.width, error)) {
+        fmt::print(stderr, "Could not create a GL context: {}\n", error);
+        return 1;
+    }
+    fmt::print("{} on {}\n", reinterpret_cast<const char*>(glGetString(GL_VERSION)), reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+#else
+    if (options.render > 0) {
+        fmt::print(stderr, "good-grid-bench doesn't draw anything, use good-grid-render-bench for --render\n");
+        return 2;
+    }
+#endif
+
+    CCShaderCache::sharedShaderCache()->loadDefaultShaders();
+    auto& api = DrawGridAPI::get();
+    int failures = 0;
+
+    for (size_t size : options.sizes) {
+        const auto buildStart = std::chrono::steady_clock::now();
+        SyntheticLevel level({.triggers = size});
+        const std::chrono::duration<float, std::milli> buildElapsed = std::chrono::steady_clock::now() - buildStart;
+        fmt::print("{} triggers, {:.0f} units long, generated in {:.1f}ms\n", size, level.getLength(), buildElapsed.count());
+
+        // what the hooks do when the editor opens
+        LevelEditorLayer::setCurrent(level.getEditorLayer());
+        api.init(level.getDrawGridLayer(), CCShaderCache::sharedShaderCache()->programForKey(kCCShader_PositionColor));
+        api.generateTimeMarkers();
+        // the first frame builds the trigger tables and grows the buffers, it isn't timed
+        api.draw();
+
+        benchmarkFrames(api, options.frames);
+
+        BenchmarkOptions benchmark;
+        benchmark.iterations = options.iterations;
+        auto results = api.runBenchmark(benchmark);
+        if (!results) {
+            fmt::print(stderr, "  runBenchmark failed: {}\n", results.unwrapErr());
+            ++failures;
+        }
+        else {
+            for (const auto& result : results.unwrap()) {
+                fmt::print("  zoom {} rotation {}: {:.3f}ms avg, {:.3f}ms p99\n", result.zoom, result.rotation, result.averageMs, result.p99Ms);
+                if (!options.nodes) continue;
+                for (const auto& node : result.nodes) {
+                    fmt::print("    {}: {:.3f}ms avg, {:.3f}ms p99, {} primitives\n", node.id, node.averageMs, node.p99Ms, node.primitives);
+                }
+            }
+        }
+
+        if (options.render > 0) {
+            auto renders = api.runRenderBenchmark(options.render, options.width);
+            if (!renders) {
+                fmt::print(stderr, "  runRenderBenchmark failed: {}\n", renders.unwrapErr());
+                ++failures;
+            }
+            else {
+                for (const auto& render : renders.unwrap()) {
+                    fmt::print("  render {}: {:.3f}ms avg, {:.3f}ms p99, checksum {:016x}\n", render.scenario, render.averageMs, render.p99Ms, render.checksum);
+                }
+            }
+        }
+
+        api.releasePersistentBuffers();
+        CCPoolManager::sharedPoolManager()->pop();
+    }
+
+    return failures ? 1 : 0;
+}
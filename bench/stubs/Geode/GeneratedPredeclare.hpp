@@ -0,0 +1,61 @@
+#pragma once
+
+#include <ccTypes.h>
+#include <utility>
+
+#define GEODE_IS_DESKTOP
+
+namespace cocos2d {
+    class CCArray;
+    class CCGLProgram;
+    class CCNode;
+    class CCObject;
+    class CCRenderTexture;
+}
+
+class AudioLineGuideGameObject;
+class DrawGridLayer;
+class EditorUI;
+class EffectGameObject;
+class GameObject;
+class LevelEditorLayer;
+
+namespace geode {
+    // retains what it holds, T only has to be complete where a Ref to it is assigned or destroyed
+    template <class T>
+    class Ref {
+        T* m_object = nullptr;
+
+    public:
+        Ref() = default;
+        Ref(T* object) : m_object(object) {
+            if (m_object) m_object->retain();
+        }
+        Ref(const Ref& other) : Ref(other.m_object) {}
+        Ref(Ref&& other) noexcept : m_object(std::exchange(other.m_object, nullptr)) {}
+        ~Ref() {
+            if (m_object) m_object->release();
+        }
+
+        Ref& operator=(T* object) {
+            if (object) object->retain();
+            if (m_object) m_object->release();
+            m_object = object;
+            return *this;
+        }
+        Ref& operator=(const Ref& other) {
+            return *this = other.m_object;
+        }
+        Ref& operator=(Ref&& other) noexcept {
+            if (this != &other) {
+                if (m_object) m_object->release();
+                m_object = std::exchange(other.m_object, nullptr);
+            }
+            return *this;
+        }
+
+        T* data() const { return m_object; }
+        T* operator->() const { return m_object; }
+        operator T*() const { return m_object; }
+    };
+}
@@ -0,0 +1,683 @@
+#pragma once
+
+#include <ccTypes.h>
+#include <Geode/Result.hpp>
+#include <Geode/GeneratedPredeclare.hpp>
+#include <Geode/cocos/cocoa/CCObject.h>
+#include <Geode/cocos/shaders/CCGLProgram.h>
+#include <fmt/format.h>
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#define CC_DEGREES_TO_RADIANS(angle) ((angle) * 0.01745329252f)
+#define CC_RADIANS_TO_DEGREES(angle) ((angle) * 57.29577951f)
+
+enum {
+    kCCVertexAttrib_Position,
+    kCCVertexAttrib_Color,
+    kCCVertexAttrib_TexCoords,
+    kCCVertexAttrib_MAX,
+};
+
+enum {
+    kCCVertexAttribFlag_None = 0,
+    kCCVertexAttribFlag_Position = 1 << 0,
+    kCCVertexAttribFlag_Color = 1 << 1,
+    kCCVertexAttribFlag_TexCoords = 1 << 2,
+    kCCVertexAttribFlag_PosColorTex = kCCVertexAttribFlag_Position | kCCVertexAttribFlag_Color | kCCVertexAttribFlag_TexCoords,
+};
+
+#define kCCShader_PositionColor "ShaderPositionColor"
+#define kCCShader_PositionTexture "ShaderPositionTexture"
+#define kCCAttributeNamePosition "a_position"
+#define kCCAttributeNameColor "a_color"
+#define kCCAttributeNameTexCoord "a_texCoord"
+
+#define KM_GL_MODELVIEW 0x1700
+#define KM_GL_PROJECTION 0x1701
+
+struct kmMat4 {
+    float mat[16];
+};
+
+void kmGLMatrixMode(unsigned mode);
+void kmGLPushMatrix();
+void kmGLPopMatrix();
+void kmGLLoadIdentity();
+void kmGLMultMatrix(const kmMat4* matrix);
+void kmGLTranslatef(float x, float y, float z);
+void kmGLRotatef(float angle, float x, float y, float z);
+void kmGLScalef(float x, float y, float z);
+void kmGLGetMatrix(unsigned mode, kmMat4* matrix);
+
+namespace cocos2d {
+    struct CCAffineTransform {
+        float a, b, c, d;
+        float tx, ty;
+    };
+
+    inline CCAffineTransform CCAffineTransformConcat(const CCAffineTransform& t1, const CCAffineTransform& t2) {
+        return {
+            t1.a * t2.a + t1.b * t2.c, t1.a * t2.b + t1.b * t2.d,
+            t1.c * t2.a + t1.d * t2.c, t1.c * t2.b + t1.d * t2.d,
+            t1.tx * t2.a + t1.ty * t2.c + t2.tx, t1.tx * t2.b + t1.ty * t2.d + t2.ty
+        };
+    }
+
+    inline CCAffineTransform CCAffineTransformInvert(const CCAffineTransform& t) {
+        const float determinant = 1 / (t.a * t.d - t.b * t.c);
+        return {
+            determinant * t.d, -determinant * t.b, -determinant * t.c, determinant * t.a,
+            determinant * (t.c * t.ty - t.d * t.tx), determinant * (t.b * t.tx - t.a * t.ty)
+        };
+    }
+
+    inline CCPoint CCPointApplyAffineTransform(const CCPoint& point, const CCAffineTransform& t) {
+        return {t.a * point.x + t.c * point.y + t.tx, t.b * point.x + t.d * point.y + t.ty};
+    }
+
+    void CGAffineToGL(const CCAffineTransform* t, GLfloat* m);
+
+    void ccGLUseProgram(GLuint program);
+    void ccGLDeleteProgram(GLuint program);
+    void ccGLBlendFunc(GLenum sfactor, GLenum dfactor);
+    void ccGLEnableVertexAttribs(unsigned int flags);
+    void ccGLBindTexture2D(GLuint textureId);
+    void ccGLBindTexture2DN(GLuint textureUnit, GLuint textureId);
+    void ccGLDeleteTexture(GLuint textureId);
+
+    class CCArray : public CCObject {
+        std::vector<CCObject*> m_objects;
+
+    public:
+        ~CCArray() override {
+            removeAllObjects();
+        }
+
+        static CCArray* create() {
+            auto array = new CCArray();
+            array->autorelease();
+            return array;
+        }
+
+        unsigned count() const {
+            return static_cast<unsigned>(m_objects.size());
+        }
+
+        CCObject* objectAtIndex(unsigned index) {
+            return m_objects[index];
+        }
+
+        void addObject(CCObject* object) {
+            object->retain();
+            m_objects.push_back(object);
+        }
+
+        void removeAllObjects() {
+            for (auto object : m_objects) object->release();
+            m_objects.clear();
+        }
+    };
+
+    class CCString : public CCObject {
+        std::string m_string;
+
+    public:
+        explicit CCString(std::string string) : m_string(std::move(string)) {}
+
+        static CCString* create(std::string string) {
+            auto created = new CCString(std::move(string));
+            created->autorelease();
+            return created;
+        }
+
+        const char* getCString() const {
+            return m_string.c_str();
+        }
+    };
+
+    // layers ignore their anchor point like CCLayer does, which is all the editor's layers are
+    class CCNode : public CCObject {
+        CCPoint m_position;
+        CCSize m_contentSize;
+        float m_scale = 1;
+        CCNode* m_parent = nullptr;
+        std::vector<CCNode*> m_children;
+        std::string m_id;
+
+    public:
+        ~CCNode() override {
+            for (auto child : m_children) {
+                child->m_parent = nullptr;
+                child->release();
+            }
+        }
+
+        virtual void draw() {}
+
+        const CCPoint& getPosition() const { return m_position; }
+        void setPosition(const CCPoint& position) { m_position = position; }
+        float getPositionX() const { return m_position.x; }
+        float getPositionY() const { return m_position.y; }
+        void setPositionX(float x) { m_position.x = x; }
+        void setPositionY(float y) { m_position.y = y; }
+
+        float getScale() const { return m_scale; }
+        void setScale(float scale) { m_scale = scale; }
+
+        const CCSize& getContentSize() const { return m_contentSize; }
+        void setContentSize(const CCSize& size) { m_contentSize = size; }
+
+        const std::string& getID() const { return m_id; }
+        void setID(std::string id) { m_id = std::move(id); }
+
+        CCNode* getParent() { return m_parent; }
+
+        void addChild(CCNode* child) {
+            child->retain();
+            child->m_parent = this;
+            m_children.push_back(child);
+        }
+
+        CCAffineTransform nodeToParentTransform() const {
+            return {m_scale, 0, 0, m_scale, m_position.x, m_position.y};
+        }
+
+        CCAffineTransform nodeToWorldTransform() const {
+            auto transform = nodeToParentTransform();
+            for (auto parent = m_parent; parent; parent = parent->m_parent) {
+                transform = CCAffineTransformConcat(transform, parent->nodeToParentTransform());
+            }
+            return transform;
+        }
+
+        CCPoint convertToNodeSpace(const CCPoint& worldPoint) const {
+            return CCPointApplyAffineTransform(worldPoint, CCAffineTransformInvert(nodeToWorldTransform()));
+        }
+    };
+
+    class CCLayer : public CCNode {};
+
+    class CCTexture2D : public CCObject {
+        GLuint m_name = 0;
+
+    public:
+        CCTexture2D(int width, int height);
+        ~CCTexture2D() override;
+
+        GLuint getName() const {
+            return m_name;
+        }
+
+        void setAliasTexParameters();
+    };
+
+    class CCSprite : public CCNode {
+        geode::Ref<CCTexture2D> m_texture;
+
+    public:
+        explicit CCSprite(CCTexture2D* texture) : m_texture(texture) {}
+
+        CCTexture2D* getTexture() {
+            return m_texture;
+        }
+    };
+
+    // renders into a texture the size it was made with, the window mapped onto all of it
+    class CCRenderTexture : public CCNode {
+        geode::Ref<CCSprite> m_sprite;
+        GLuint m_fbo = 0;
+        GLint m_oldFBO = 0;
+        GLint m_oldViewport[4] = {};
+        int m_width = 0;
+        int m_height = 0;
+
+    public:
+        ~CCRenderTexture() override;
+
+        static CCRenderTexture* create(int width, int height);
+
+        void begin();
+        void beginWithClear(float r, float g, float b, float a);
+        void end();
+
+        CCSprite* getSprite() {
+            return m_sprite;
+        }
+    };
+
+    class CCConfiguration {
+    public:
+        static CCConfiguration* sharedConfiguration() {
+            static CCConfiguration instance;
+            return &instance;
+        }
+
+        bool checkForGLExtension(const std::string& searchName) const;
+    };
+
+    class CCShaderCache {
+        std::map<std::string, geode::Ref<CCGLProgram>> m_programs;
+
+    public:
+        static CCShaderCache* sharedShaderCache() {
+            static CCShaderCache instance;
+            return &instance;
+        }
+
+        // the two programs the grid borrows from cocos
+        void loadDefaultShaders();
+
+        CCGLProgram* programForKey(const char* key) {
+            auto it = m_programs.find(key);
+            return it == m_programs.end() ? nullptr : it->second.data();
+        }
+
+        void addProgram(CCGLProgram* program, const char* key) {
+            m_programs[key] = program;
+        }
+
+        void purgeSharedShaderCache() {
+            m_programs.clear();
+        }
+    };
+
+    class CCDirector {
+        CCSize m_winSize{569, 320};
+        CCSize m_winSizeInPixels{1138, 640};
+
+    public:
+        static CCDirector* get() {
+            static CCDirector instance;
+            return &instance;
+        }
+
+        static CCDirector* sharedDirector() {
+            return get();
+        }
+
+        CCSize getWinSize() const { return m_winSize; }
+        CCSize getWinSizeInPixels() const { return m_winSizeInPixels; }
+        float getContentScaleFactor() const { return m_winSizeInPixels.width / m_winSize.width; }
+
+        // there's no window, so its size is whatever the bench says it is
+        void setWinSize(const CCSize& points, const CCSize& pixels) {
+            m_winSize = points;
+            m_winSizeInPixels = pixels;
+        }
+    };
+}
+
+enum class PlaybackMode {
+    Not = 0,
+    Playing = 1,
+    Paused = 2,
+};
+
+enum class Speed {
+    Normal = 0,
+    Slow = 1,
+    Fast = 2,
+    Faster = 3,
+    Fastest = 4,
+};
+
+enum class GameObjectType {
+    Solid = 0,
+    Hazard = 2,
+    InverseGravityPortal = 3,
+    NormalGravityPortal = 4,
+    ShipPortal = 5,
+    CubePortal = 6,
+    Decoration = 7,
+    YellowJumpPad = 8,
+    PinkJumpPad = 9,
+    GravityPad = 10,
+    YellowJumpRing = 11,
+    PinkJumpRing = 12,
+    GravityRing = 13,
+    InverseMirrorPortal = 14,
+    NormalMirrorPortal = 15,
+    BallPortal = 16,
+    RegularSizePortal = 17,
+    MiniSizePortal = 18,
+    UfoPortal = 19,
+    Modifier = 20,
+    Breakable = 21,
+    SecretCoin = 22,
+    DualPortal = 23,
+    SoloPortal = 24,
+    Slope = 25,
+    WavePortal = 26,
+    RobotPortal = 27,
+    TeleportPortal = 28,
+    GreenRing = 29,
+    Collectible = 30,
+    UserCoin = 31,
+    DropRing = 32,
+    SpiderPortal = 33,
+    RedJumpPad = 34,
+    RedJumpRing = 35,
+    CustomRing = 36,
+    DashRing = 37,
+    GravityDashRing = 38,
+    CollisionObject = 39,
+    Special = 40,
+    SwingPortal = 41,
+    GravityTogglePortal = 42,
+    SpiderOrb = 43,
+    SpiderPad = 44,
+    EnterEffectObject = 46,
+    TeleportOrb = 47,
+    AnimatedHazard = 48,
+};
+
+struct GJGameState {
+    float m_cameraAngle = 0;
+    bool m_isDualMode = false;
+    bool m_unkBool8 = false;
+    int m_rotateChannel = 0;
+    cocos2d::CCPoint m_cameraPosition;
+};
+
+class LevelSettingsObject : public cocos2d::CCNode {
+public:
+    bool m_dynamicLevelHeight = false;
+    Speed m_startSpeed = Speed::Normal;
+};
+
+class GameObject : public cocos2d::CCNode {
+public:
+    GameObjectType m_objectType = GameObjectType::Solid;
+    bool m_isHide = false;
+    bool m_isGroupDisabled = false;
+    bool m_isInvisible = false;
+    bool m_isSelected = false;
+    int m_objectID = 0;
+    int m_uniqueID = 0;
+};
+
+class EffectGameObject : public GameObject {
+public:
+    bool m_isSpawnTriggered = false;
+    bool m_isTouchTriggered = false;
+    float m_duration = 0;
+    float m_fadeInDuration = 0;
+    float m_holdDuration = 0;
+    float m_fadeOutDuration = 0;
+    cocos2d::CCPoint m_endPosition;
+    int m_ordValue = 0;
+    int m_channelValue = 0;
+};
+
+class SFXTriggerGameObject : public EffectGameObject {
+public:
+    float m_soundDuration = 0;
+};
+
+class AudioLineGuideGameObject : public EffectGameObject {
+public:
+    bool m_disabled = false;
+    Speed m_speed = Speed::Normal;
+    int m_beatsPerBar = 4;
+    float m_beatsPerMinute = 120;
+};
+
+class PlayerObject : public GameObject {
+public:
+    bool m_isInBasicMode = true;
+
+    bool isInBasicMode() const {
+        return m_isInBasicMode;
+    }
+};
+
+class EditorUI : public cocos2d::CCLayer {
+public:
+    GameObject* m_snapObject = nullptr;
+    GameObject* m_selectedObject = nullptr;
+    cocos2d::CCArray* m_selectedObjects = nullptr;
+    float m_toolbarHeight = 90;
+};
+
+class LevelEditorLayer : public cocos2d::CCLayer {
+    static inline LevelEditorLayer* s_current = nullptr;
+
+public:
+    DrawGridLayer* m_drawGridLayer = nullptr;
+    PlaybackMode m_playbackMode = PlaybackMode::Not;
+    cocos2d::CCLayer* m_objectLayer = nullptr;
+    GJGameState m_gameState;
+    LevelSettingsObject* m_levelSettings = nullptr;
+    bool m_showGrid = true;
+    bool m_hideGridOnPlay = false;
+    bool m_showGround = true;
+    bool m_drawEffectLines = true;
+    bool m_showDurationLines = true;
+    bool m_isPlatformer = false;
+    bool m_playbackActive = false;
+    cocos2d::CCArray* m_durationObjects = nullptr;
+    EditorUI* m_editorUI = nullptr;
+    PlayerObject* m_player1 = nullptr;
+    cocos2d::CCPoint m_previewPosition;
+    cocos2d::CCArray* m_objects = nullptr;
+    cocos2d::CCArray* m_undoObjects = nullptr;
+    cocos2d::CCArray* m_redoObjects = nullptr;
+    int m_currentLayer = -1;
+    float m_minPortalY = 90;
+    float m_maxPortalY = 390;
+
+    static LevelEditorLayer* get() {
+        return s_current;
+    }
+
+    static void setCurrent(LevelEditorLayer* editorLayer) {
+        s_current = editorLayer;
+    }
+
+    float getMinPortalY() const { return m_minPortalY; }
+    float getMaxPortalY() const { return m_maxPortalY; }
+};
+
+class DrawGridLayer : public cocos2d::CCLayer {
+public:
+    LevelEditorLayer* m_editorLayer = nullptr;
+    float m_gridSize = 30;
+    cocos2d::CCArray* m_timeMarkers = nullptr;
+    cocos2d::CCArray* m_guideObjects = nullptr;
+    cocos2d::CCArray* m_effectGameObjects = nullptr;
+    cocos2d::CCArray* m_speedObjects = nullptr;
+    bool m_updateTimeMarkers = false;
+    std::map<int, AudioLineGuideGameObject*> m_audioLineObjects;
+    float m_normalSpeed = 311.58f;
+    float m_slowSpeed = 251.16f;
+    float m_fastSpeed = 387.42f;
+    float m_fasterSpeed = 468.0f;
+    float m_fastestSpeed = 576.0f;
+    float m_playbackX = 0;
+    float m_playbackY = 0;
+    float m_playbackTime = 0;
+
+    // the game's own grid, which the host doesn't have
+    void draw() override {}
+};
+
+class GameManager {
+    std::unordered_map<std::string, bool> m_variables;
+
+public:
+    bool m_showSongMarkers = true;
+
+    static GameManager* get() {
+        static GameManager instance;
+        return &instance;
+    }
+
+    bool getGameVariable(const char* key) {
+        return m_variables[key];
+    }
+
+    void setGameVariable(const char* key, bool value) {
+        m_variables[key] = value;
+    }
+};
+
+// the level plays at one speed from start to end, speed portals aren't followed
+namespace LevelTools {
+    inline constexpr float NORMAL_SPEED = 311.58f;
+
+    inline float timeForPos(cocos2d::CCPoint pos, cocos2d::CCArray*, int, int, int, bool, bool, bool, bool, bool) {
+        return pos.x / NORMAL_SPEED;
+    }
+
+    inline cocos2d::CCPoint posForTimeInternal(float time, cocos2d::CCArray*, int, bool, bool, bool, int, bool) {
+        return {time * NORMAL_SPEED, 0};
+    }
+
+    inline bool getLastGameplayRotated() {
+        return false;
+    }
+}
+
+namespace gd {
+    using string = std::string;
+}
+
+namespace geode {
+    template <class T>
+    class WeakRef {
+        T* m_object;
+
+    public:
+        WeakRef(T* object) : m_object(object) {}
+
+        Ref<T> lock() const {
+            return m_object;
+        }
+    };
+
+    template <class T>
+    class CCArrayExt {
+        cocos2d::CCArray* m_array;
+
+    public:
+        CCArrayExt(cocos2d::CCArray* array) : m_array(array) {}
+
+        size_t size() const {
+            return m_array ? m_array->count() : 0;
+        }
+
+        T operator[](size_t index) const {
+            return static_cast<T>(m_array->objectAtIndex(static_cast<unsigned>(index)));
+        }
+
+        struct iterator {
+            const CCArrayExt* array;
+            size_t index;
+
+            T operator*() const { return (*array)[index]; }
+            iterator& operator++() { ++index; return *this; }
+            bool operator!=(const iterator& other) const { return index != other.index; }
+        };
+
+        iterator begin() const { return {this, 0}; }
+        iterator end() const { return {this, size()}; }
+    };
+
+    template <class T>
+    Result<T> numFromString(std::string_view text) {
+        T value{};
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (error != std::errc{} || end != text.data() + text.size()) return Err(fmt::format("Invalid number: {}", text));
+        return Ok(value);
+    }
+
+    class Mod {
+        using Value = std::variant<bool, int64_t, double, std::string>;
+        std::unordered_map<std::string, Value> m_settings;
+        std::unordered_map<std::string, Value> m_saved;
+
+    public:
+        static Mod* get() {
+            static Mod instance;
+            return &instance;
+        }
+
+        template <class T>
+        T getSettingValue(std::string_view key) const {
+            auto it = m_settings.find(std::string(key));
+            if (it == m_settings.end() || !std::holds_alternative<T>(it->second)) return T{};
+            return std::get<T>(it->second);
+        }
+
+        template <class T>
+        void setSettingValue(std::string_view key, T value) {
+            m_settings[std::string(key)] = Value(std::move(value));
+        }
+
+        template <class T>
+        T getSavedValue(std::string_view key) const {
+            auto it = m_saved.find(std::string(key));
+            if (it == m_saved.end() || !std::holds_alternative<T>(it->second)) return T{};
+            return std::get<T>(it->second);
+        }
+
+        std::filesystem::path getSaveDir() const {
+            auto dir = std::filesystem::temp_directory_path() / "good-grid";
+            std::filesystem::create_directories(dir);
+            return dir;
+        }
+    };
+
+    // no other mods are ever loaded next to the bench
+    class Loader {
+    public:
+        static Loader* get() {
+            static Loader instance;
+            return &instance;
+        }
+
+        bool isModLoaded(std::string_view) const {
+            return false;
+        }
+
+        Mod* getLoadedMod(std::string_view) const {
+            return nullptr;
+        }
+    };
+
+    namespace log {
+        template <class... A>
+        void debug(fmt::format_string<A...> format, A&&... args) {
+            std::fprintf(stderr, "[debug] %s\n", fmt::format(format, std::forward<A>(args)...).c_str());
+        }
+
+        template <class... A>
+        void info(fmt::format_string<A...> format, A&&... args) {
+            std::fprintf(stderr, "[info] %s\n", fmt::format(format, std::forward<A>(args)...).c_str());
+        }
+
+        template <class... A>
+        void warn(fmt::format_string<A...> format, A&&... args) {
+            std::fprintf(stderr, "[warn] %s\n", fmt::format(format, std::forward<A>(args)...).c_str());
+        }
+
+        template <class... A>
+        void error(fmt::format_string<A...> format, A&&... args) {
+            std::fprintf(stderr, "[error] %s\n", fmt::format(format, std::forward<A>(args)...).c_str());
+        }
+    }
+
+    namespace prelude {
+        using namespace ::cocos2d;
+        using namespace ::geode;
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <ccTypes.h>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace geode {
+    // holds a reference to lvalues, the result it's turned into decides whether that's copied
+    template <class T>
+    struct OkValue {
+        T value;
+    };
+
+    struct ErrValue {
+        std::string error;
+    };
+
+    template <class T>
+    OkValue<T&&> Ok(T&& value) {
+        return {std::forward<T>(value)};
+    }
+
+    inline ErrValue Err(std::string message) {
+        return {std::move(message)};
+    }
+
+    template <class T = void>
+    class Result {
+        using Stored = std::conditional_t<std::is_void_v<T>, std::monostate, std::conditional_t<std::is_reference_v<T>, std::remove_reference_t<T>*, T>>;
+        std::variant<Stored, std::string> m_value;
+
+    public:
+        template <class U>
+        Result(OkValue<U>&& ok) {
+            if constexpr (std::is_reference_v<T>) m_value.template emplace<0>(&ok.value);
+            else if constexpr (std::is_void_v<T>) m_value.template emplace<0>();
+            else m_value.template emplace<0>(std::forward<U>(ok.value));
+        }
+
+        Result(ErrValue&& err) {
+            m_value.template emplace<1>(std::move(err.error));
+        }
+
+        bool isOk() const { return m_value.index() == 0; }
+        bool isErr() const { return m_value.index() == 1; }
+        explicit operator bool() const { return isOk(); }
+
+        decltype(auto) unwrap() {
+            if constexpr (std::is_reference_v<T>) return static_cast<T>(*std::get<0>(m_value));
+            else if constexpr (!std::is_void_v<T>) return std::move(std::get<0>(m_value));
+        }
+
+        T unwrapOrDefault() requires (!std::is_void_v<T> && !std::is_reference_v<T>) {
+            return isOk() ? std::get<0>(m_value) : T{};
+        }
+
+        std::string unwrapErr() const {
+            return isErr() ? std::get<1>(m_value) : std::string{};
+        }
+    };
+
+    namespace cast {
+        template <class T, class U>
+        T typeinfo_cast(U* object) {
+            return dynamic_cast<T>(object);
+        }
+    }
+}
+
+#define GEODE_UNWRAP_INTO(variable, ...) \
+    auto unwrapResult = (__VA_ARGS__); \
+    if (!unwrapResult) return geode::Err(unwrapResult.unwrapErr()); \
+    variable = unwrapResult.unwrap()
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <ccTypes.h>
+#include <vector>
+
+namespace cocos2d {
+    // reference counted like cocos: created with one reference, autoreleased ones go when the pool is drained
+    class CCObject {
+        unsigned m_retainCount = 1;
+
+    public:
+        CCObject() = default;
+        CCObject(const CCObject&) = delete;
+        CCObject& operator=(const CCObject&) = delete;
+        virtual ~CCObject() = default;
+
+        void retain() {
+            ++m_retainCount;
+        }
+
+        void release() {
+            if (--m_retainCount == 0) delete this;
+        }
+
+        CCObject* autorelease();
+
+        unsigned retainCount() const {
+            return m_retainCount;
+        }
+    };
+
+    class CCPoolManager {
+        std::vector<CCObject*> m_objects;
+
+    public:
+        static CCPoolManager* sharedPoolManager() {
+            static CCPoolManager instance;
+            return &instance;
+        }
+
+        void addObject(CCObject* object) {
+            m_objects.push_back(object);
+        }
+
+        void pop() {
+            auto objects = std::move(m_objects);
+            m_objects.clear();
+            for (auto object : objects) object->release();
+        }
+    };
+
+    inline CCObject* CCObject::autorelease() {
+        CCPoolManager::sharedPoolManager()->addObject(this);
+        return this;
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <ccTypes.h>
+#include <Geode/cocos/cocoa/CCObject.h>
+
+namespace cocos2d {
+    enum {
+        kCCUniformPMatrix,
+        kCCUniformMVMatrix,
+        kCCUniformMVPMatrix,
+        kCCUniform_MAX,
+    };
+
+    // compiles with the same preamble and builtin uniforms as cocos, so the grid's shaders build unchanged
+    class CCGLProgram : public CCObject {
+        GLuint m_program = 0;
+        GLuint m_vertShader = 0;
+        GLuint m_fragShader = 0;
+        GLint m_uniforms[kCCUniform_MAX] = {-1, -1, -1};
+
+    public:
+        CCGLProgram() = default;
+        ~CCGLProgram() override;
+
+        bool initWithVertexShaderByteArray(const GLchar* vShaderByteArray, const GLchar* fShaderByteArray);
+        void addAttribute(const char* attributeName, GLuint index);
+        bool link();
+        void use();
+        void updateUniforms();
+        void setUniformsForBuiltins();
+
+        GLint getUniformLocationForName(const char* name);
+        void setUniformLocationWith1i(GLint location, GLint i1);
+        void setUniformLocationWith1f(GLint location, GLfloat f1);
+        void setUniformLocationWith2f(GLint location, GLfloat f1, GLfloat f2);
+        void setUniformLocationWith4f(GLint location, GLfloat f1, GLfloat f2, GLfloat f3, GLfloat f4);
+
+        GLuint getProgram() const {
+            return m_program;
+        }
+    };
+}
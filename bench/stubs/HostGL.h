@@ -0,0 +1,147 @@
+#pragma once
+
+/*
+    The part of OpenGL the grid and the cocos stubs use. With GOOD_GRID_HOST_GL it's the system's headers and a
+    real context, otherwise it's declared here and HostGL.cpp turns every call into a no-op, so the CPU side
+    can be benchmarked on a machine without any GL.
+*/
+#ifdef GOOD_GRID_HOST_GL
+
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+#else
+
+#include <cstddef>
+#include <cstdint>
+
+using GLenum = unsigned int;
+using GLboolean = unsigned char;
+using GLbitfield = unsigned int;
+using GLbyte = signed char;
+using GLubyte = unsigned char;
+using GLshort = short;
+using GLushort = unsigned short;
+using GLint = int;
+using GLuint = unsigned int;
+using GLsizei = int;
+using GLfloat = float;
+using GLclampf = float;
+using GLchar = char;
+using GLsizeiptr = std::ptrdiff_t;
+using GLintptr = std::ptrdiff_t;
+using GLint64 = int64_t;
+using GLuint64 = uint64_t;
+
+#define GL_FALSE 0
+#define GL_TRUE 1
+#define GL_ZERO 0
+#define GL_ONE 1
+#define GL_LINES 0x0001
+#define GL_TRIANGLES 0x0004
+#define GL_TRIANGLE_STRIP 0x0005
+#define GL_SRC_ALPHA 0x0302
+#define GL_ONE_MINUS_SRC_ALPHA 0x0303
+#define GL_ONE_MINUS_DST_COLOR 0x0307
+#define GL_LINE_SMOOTH 0x0B20
+#define GL_BLEND 0x0BE2
+#define GL_VIEWPORT 0x0BA2
+#define GL_LINE_SMOOTH_HINT 0x0C52
+#define GL_UNPACK_ALIGNMENT 0x0CF5
+#define GL_TEXTURE_2D 0x0DE1
+#define GL_NICEST 0x1102
+#define GL_UNSIGNED_BYTE 0x1401
+#define GL_FLOAT 0x1406
+#define GL_RGBA 0x1908
+#define GL_LUMINANCE_ALPHA 0x190A
+#define GL_VERSION 0x1F02
+#define GL_EXTENSIONS 0x1F03
+#define GL_NEAREST 0x2600
+#define GL_LINEAR 0x2601
+#define GL_TEXTURE_MAG_FILTER 0x2800
+#define GL_TEXTURE_MIN_FILTER 0x2801
+#define GL_TEXTURE_WRAP_S 0x2802
+#define GL_TEXTURE_WRAP_T 0x2803
+#define GL_CLAMP_TO_EDGE 0x812F
+#define GL_BLEND_DST_ALPHA 0x80CA
+#define GL_BLEND_SRC_ALPHA 0x80CB
+#define GL_TEXTURE0 0x84C0
+#define GL_TIME_ELAPSED 0x88BF
+#define GL_QUERY_RESULT 0x8866
+#define GL_QUERY_RESULT_AVAILABLE 0x8867
+#define GL_ARRAY_BUFFER 0x8892
+#define GL_STATIC_DRAW 0x88E4
+#define GL_FRAGMENT_SHADER 0x8B30
+#define GL_VERTEX_SHADER 0x8B31
+#define GL_COMPILE_STATUS 0x8B81
+#define GL_LINK_STATUS 0x8B82
+#define GL_FRAMEBUFFER_BINDING 0x8CA6
+#define GL_FRAMEBUFFER_COMPLETE 0x8CD5
+#define GL_COLOR_ATTACHMENT0 0x8CE0
+#define GL_FRAMEBUFFER 0x8D40
+#define GL_COLOR_BUFFER_BIT 0x00004000
+
+extern "C" {
+    void glActiveTexture(GLenum texture);
+    void glAttachShader(GLuint program, GLuint shader);
+    void glBeginQuery(GLenum target, GLuint id);
+    void glBindAttribLocation(GLuint program, GLuint index, const GLchar* name);
+    void glBindBuffer(GLenum target, GLuint buffer);
+    void glBindFramebuffer(GLenum target, GLuint framebuffer);
+    void glBindTexture(GLenum target, GLuint texture);
+    void glBlendFunc(GLenum sfactor, GLenum dfactor);
+    void glBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage);
+    GLenum glCheckFramebufferStatus(GLenum target);
+    void glClear(GLbitfield mask);
+    void glClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+    void glCompileShader(GLuint shader);
+    GLuint glCreateProgram();
+    GLuint glCreateShader(GLenum type);
+    void glDeleteBuffers(GLsizei n, const GLuint* buffers);
+    void glDeleteFramebuffers(GLsizei n, const GLuint* framebuffers);
+    void glDeleteProgram(GLuint program);
+    void glDeleteQueries(GLsizei n, const GLuint* ids);
+    void glDeleteShader(GLuint shader);
+    void glDeleteTextures(GLsizei n, const GLuint* textures);
+    void glDisable(GLenum cap);
+    void glDisableVertexAttribArray(GLuint index);
+    void glDrawArrays(GLenum mode, GLint first, GLsizei count);
+    void glEnable(GLenum cap);
+    void glEnableVertexAttribArray(GLuint index);
+    void glEndQuery(GLenum target);
+    void glFinish();
+    void glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+    void glGenBuffers(GLsizei n, GLuint* buffers);
+    void glGenFramebuffers(GLsizei n, GLuint* framebuffers);
+    void glGenQueries(GLsizei n, GLuint* ids);
+    void glGenTextures(GLsizei n, GLuint* textures);
+    void glGetIntegerv(GLenum pname, GLint* data);
+    void glGetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei* length, GLchar* infoLog);
+    void glGetProgramiv(GLuint program, GLenum pname, GLint* params);
+    void glGetQueryObjectiv(GLuint id, GLenum pname, GLint* params);
+    void glGetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params);
+    void glGetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog);
+    void glGetShaderiv(GLuint shader, GLenum pname, GLint* params);
+    const GLubyte* glGetString(GLenum name);
+    GLint glGetUniformLocation(GLuint program, const GLchar* name);
+    void glHint(GLenum target, GLenum mode);
+    void glLineWidth(GLfloat width);
+    void glLinkProgram(GLuint program);
+    void glPixelStorei(GLenum pname, GLint param);
+    void glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels);
+    void glShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length);
+    void glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels);
+    void glTexParameteri(GLenum target, GLenum pname, GLint param);
+    void glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels);
+    void glUniform1f(GLint location, GLfloat v0);
+    void glUniform1i(GLint location, GLint v0);
+    void glUniform2f(GLint location, GLfloat v0, GLfloat v1);
+    void glUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3);
+    void glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+    void glUseProgram(GLuint program);
+    void glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer);
+    void glViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+}
+
+#endif
@@ -0,0 +1,99 @@
+#pragma once
+
+/*
+    Stand-ins for the parts of cocos2d and Geode that Good Grid's sources touch, just enough to build them
+    into a program of their own. Nothing here tries to be cocos, only to behave the way the grid expects.
+*/
+#include "HostGL.h"
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+    The export macros only matter for the DLL. GCC won't take the GNU attribute the other platforms use in
+    front of alignas, so the Windows branch is taken with __declspec expanding to nothing.
+*/
+#define GEODE_IS_WINDOWS
+#define __declspec(attributes)
+
+namespace cocos2d {
+    struct ccVertex2F {
+        GLfloat x;
+        GLfloat y;
+    };
+
+    struct ccColor3B {
+        GLubyte r;
+        GLubyte g;
+        GLubyte b;
+    };
+
+    struct ccColor4B {
+        GLubyte r;
+        GLubyte g;
+        GLubyte b;
+        GLubyte a;
+    };
+
+    class CCPoint {
+    public:
+        float x = 0;
+        float y = 0;
+
+        CCPoint() = default;
+        CCPoint(float x, float y) : x(x), y(y) {}
+
+        CCPoint operator+(const CCPoint& other) const { return {x + other.x, y + other.y}; }
+        CCPoint operator-(const CCPoint& other) const { return {x - other.x, y - other.y}; }
+        CCPoint operator-() const { return {-x, -y}; }
+        CCPoint operator*(float scale) const { return {x * scale, y * scale}; }
+        CCPoint operator/(float scale) const { return {x / scale, y / scale}; }
+        bool operator==(const CCPoint& other) const { return x == other.x && y == other.y; }
+        bool operator!=(const CCPoint& other) const { return !(*this == other); }
+
+        float getLength() const { return std::sqrt(x * x + y * y); }
+    };
+
+    class CCSize {
+    public:
+        float width = 0;
+        float height = 0;
+
+        CCSize() = default;
+        CCSize(float width, float height) : width(width), height(height) {}
+
+        CCSize operator*(float scale) const { return {width * scale, height * scale}; }
+        CCSize operator/(float scale) const { return {width / scale, height / scale}; }
+        bool operator==(const CCSize& other) const { return width == other.width && height == other.height; }
+    };
+
+    class CCRect {
+    public:
+        CCPoint origin;
+        CCSize size;
+
+        CCRect() = default;
+        CCRect(float x, float y, float width, float height) : origin(x, y), size(width, height) {}
+
+        float getMinX() const { return origin.x; }
+        float getMidX() const { return origin.x + size.width * 0.5f; }
+        float getMaxX() const { return origin.x + size.width; }
+        float getMinY() const { return origin.y; }
+        float getMidY() const { return origin.y + size.height * 0.5f; }
+        float getMaxY() const { return origin.y + size.height; }
+
+        bool intersectsRect(const CCRect& rect) const {
+            return !(getMaxX() < rect.getMinX() || rect.getMaxX() < getMinX() || getMaxY() < rect.getMinY() || rect.getMaxY() < getMinY());
+        }
+    };
+
+    inline const CCPoint CCPointZero{0, 0};
+}
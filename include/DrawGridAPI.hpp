@@ -4,6 +4,10 @@
 #include <Geode/cocos/shaders/CCGLProgram.h>
 #include <Geode/Result.hpp>
 #include "DrawNode.hpp"
+#include "FrameArena.hpp"
+#include <array>
+#include <typeindex>
+#include <filesystem>
 
 #ifdef GEODE_IS_WINDOWS
     #ifdef GOOD_GRID_API_EXPORTING
@@ -36,8 +40,143 @@ public:
     LineColor(const cocos2d::ccColor4B& colorA);
     LineColor(const cocos2d::ccColor4B& colorA, const cocos2d::ccColor4B& colorB);
 
-    cocos2d::ccColor4B getColorA() const;
-    cocos2d::ccColor4B getColorB() const;
+    cocos2d::ccColor4B getColorA() const {
+        return m_colorA;
+    }
+
+    cocos2d::ccColor4B getColorB() const {
+        return m_hasColorB ? m_colorB : m_colorA;
+    }
+};
+
+/*
+    The part of the level that's on screen, which is the window turned with the editor's camera, in level
+    coordinates. When the camera is turned, lines drawn through Good Grid are clipped to it so nothing is
+    rasterized past the edges of the screen.
+*/
+struct GOOD_GRID_API_DLL ViewPolygon {
+    // counter clockwise
+    std::array<cocos2d::CCPoint, 4> corners;
+    // outward facing, normals[i] belongs to the edge from corners[i] to corners[i + 1]
+    std::array<cocos2d::CCPoint, 4> normals;
+    float unitsPerPixel = 1;
+    bool rotated = false;
+
+    cocos2d::CCRect getBounds(float margin = 0) const;
+    // shortens the line to the part of it within margin of the view, false if none of it is
+    bool clipLine(cocos2d::ccVertex2F& start, cocos2d::ccVertex2F& end, float margin = 0) const;
+    // same, with the margin covering the line's width and the colors following the new ends
+    bool clipLine(cocos2d::ccVertex2F& start, cocos2d::ccVertex2F& end, cocos2d::ccColor4B& colorA, cocos2d::ccColor4B& colorB, float width) const;
+};
+
+// refers to a persistent line or rect, stays valid until it's removed
+struct PersistentHandle {
+    uint32_t index = 0;
+    uint32_t generation = 0;
+
+    bool isValid() const {
+        return generation != 0;
+    }
+};
+
+/*
+    What the trigger layers check on every object every frame, copied out of one of the editor's arrays in the
+    same order, so those loops go through a few packed arrays instead of jumping between objects all over the
+    heap. Only what can rule an object out is in here, the rest is still read off the object itself.
+*/
+struct TriggerTable {
+    enum Flags : uint8_t {
+        SPAWN_TRIGGERED = 1 << 0,
+        TOUCH_TRIGGERED = 1 << 1
+    };
+
+    std::vector<GameObject*> objects;
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<uint8_t> flags;
+    // only for effect objects, how long each one lasts
+    std::vector<float> durations;
+    // only for guide objects, what getPortalMinMax returns for each one
+    std::vector<cocos2d::CCPoint> portalRanges;
+    // bumped whenever a row changes, anything worked out from the table only has to be done again when it does
+    uint64_t generation = 0;
+
+    size_t size() const {
+        return objects.size();
+    }
+};
+
+struct FrameTimings {
+    float generateMs = 0;
+    float submitMs = 0;
+    float totalMs = 0;
+    float averageGenerateMs = 0;
+    float averageSubmitMs = 0;
+    float averageTotalMs = 0;
+    bool pipelined = false;
+};
+
+// what runBenchmark sweeps over
+struct BenchmarkOptions {
+    std::vector<float> zooms = {0.1f, 0.25f, 0.5f, 1.f, 2.f, 4.f};
+    // in degrees, only changes how much past the screen gets drawn
+    std::vector<float> rotations = {0.f, 45.f};
+    int iterations = 30;
+    // extra guidelines spread over the view on top of the level's own
+    size_t syntheticTimeMarkers = 0;
+};
+
+struct BenchmarkResult {
+    struct Node {
+        std::string id;
+        float averageMs;
+        float p99Ms;
+        uint32_t primitives;
+    };
+
+    float zoom;
+    float rotation;
+    float averageMs;
+    float p99Ms;
+    std::vector<Node> nodes;
+};
+
+namespace cocos2d {
+    class CCRenderTexture;
+}
+
+// one scenario of runRenderBenchmark
+struct RenderBenchmarkResult {
+    std::string scenario;
+    // draw() through to the GPU finishing, readback excluded
+    float averageMs = 0;
+    float p99Ms = 0;
+    // FNV-1a of the rendered pixels, only comparable between runs on the same level and window size
+    uint64_t checksum = 0;
+};
+
+struct ReplayResult {
+    cocos2d::CCRenderTexture* texture = nullptr;
+    // how long the replayed buckets took to submit and finish drawing
+    float submitMs = 0;
+    uint32_t drawCalls = 0;
+    uint32_t vertices = 0;
+};
+
+// a typed reference to a registered DrawNode, valid for as long as the DrawGridAPI that owns the node
+template <typename T>
+requires std::is_base_of_v<DrawNode, T>
+class NodeHandle {
+    T* m_node = nullptr;
+
+public:
+    NodeHandle() = default;
+    explicit NodeHandle(T* node) : m_node(node) {}
+
+    T* get() const { return m_node; }
+    T* operator->() const { return m_node; }
+    T& operator*() const { return *m_node; }
+    explicit operator bool() const { return m_node != nullptr; }
 };
 
 struct DrawGridAPIImpl;
@@ -45,12 +184,80 @@ struct DrawGridAPIImpl;
 class GOOD_GRID_API_DLL DrawGridAPI {
     std::unique_ptr<DrawGridAPIImpl> m_impl;
 
+    friend class DrawNode;
+    void renameNode(DrawNode* drawNode, const std::string& oldID);
+
 protected:
     void addDrawInternal(const std::string& id, std::unique_ptr<DrawNode> drawNode);
+    DrawNode* getNodeByType(std::type_index type, bool (*matches)(DrawNode*));
     void ensureViewTransformValid();
     void batchDraw();
-    std::array<Vertex, 6> rectToTriangles(const cocos2d::CCRect& rect, const cocos2d::ccColor4B& color);
-    std::array<Vertex, 24> rectToBorderTriangles(const cocos2d::CCRect& rect, const cocos2d::ccColor4B& color, float width);
+    std::array<Vertex, 6> rectToTriangles(const cocos2d::CCRect& rect, const cocos2d::ccColor4B& color) {
+        float x = rect.getMinX();
+        float y = rect.getMinY();
+        float w = rect.size.width;
+        float h = rect.size.height;
+
+        return {
+            Vertex{{x,     y}, color, {}},
+            Vertex{{x + w, y}, color, {}},
+            Vertex{{x + w, y + h}, color, {}},
+
+            Vertex{{x,     y}, color, {}},
+            Vertex{{x + w, y + h}, color, {}},
+            Vertex{{x,     y + h}, color, {}}
+        };
+    }
+
+    std::array<Vertex, 24> rectToBorderTriangles(const cocos2d::CCRect& rect, const cocos2d::ccColor4B& color, float width) {
+        float x = rect.getMinX();
+        float y = rect.getMinY();
+        float w = rect.size.width;
+        float h = rect.size.height;
+
+        float t = width;
+
+        float ox0 = x - t;
+        float oy0 = y - t;
+        float ox1 = x + w + t;
+        float oy1 = y + h + t;
+
+        float ix0 = x;
+        float iy0 = y;
+        float ix1 = x + w;
+        float iy1 = y + h;
+
+        return {
+            Vertex{{ox0, oy0}, color, {}},
+            Vertex{{ox1, oy0}, color, {}},
+            Vertex{{ix1, iy0}, color, {}},
+            Vertex{{ox0, oy0}, color, {}},
+            Vertex{{ix1, iy0}, color, {}},
+            Vertex{{ix0, iy0}, color, {}},
+
+            Vertex{{ox1, oy0}, color, {}},
+            Vertex{{ox1, oy1}, color, {}},
+            Vertex{{ix1, iy1}, color, {}},
+            Vertex{{ox1, oy0}, color, {}},
+            Vertex{{ix1, iy1}, color, {}},
+            Vertex{{ix1, iy0}, color, {}},
+
+            Vertex{{ox1, oy1}, color, {}},
+            Vertex{{ox0, oy1}, color, {}},
+            Vertex{{ix0, iy1}, color, {}},
+            Vertex{{ox1, oy1}, color, {}},
+            Vertex{{ix0, iy1}, color, {}},
+            Vertex{{ix1, iy1}, color, {}},
+
+            Vertex{{ox0, oy1}, color, {}},
+            Vertex{{ox0, oy0}, color, {}},
+            Vertex{{ix0, iy0}, color, {}},
+            Vertex{{ox0, oy1}, color, {}},
+            Vertex{{ix0, iy0}, color, {}},
+            Vertex{{ix0, iy1}, color, {}}
+        };
+    }
+
     const std::vector<std::unique_ptr<DrawNode>>& getDrawNodes();
     void setHideInvisible(bool enabled);
 
@@ -63,6 +270,278 @@ public:
         INVERT
     };
 
+    enum class PrimitiveKind {
+        LINE,
+        RECT,
+        RECT_OUTLINE
+    };
+
+    enum class ColumnAggregation {
+        OFF,
+        // a merged line is as opaque as the most opaque line in it
+        MAX_ALPHA,
+        // a merged line is as opaque as all of its lines stacked on top of each other
+        BLENDED_ALPHA
+    };
+
+    /*
+        Writers resolve the batch buffer once when acquired and then append vertices inline in the caller,
+        skipping the exported draw functions and their draw mode switch for every primitive. Acquire them
+        inside DrawNode::draw and don't keep them across frames. They ignore setNextDrawMode.
+    */
+    template <DrawMode Mode>
+    class LineWriter {
+        static_assert(Mode != DrawMode::NONE, "LineWriter needs a concrete draw mode");
+
+        DrawGridAPI* m_api;
+        std::vector<Vertex>* m_buffer;
+        float m_width;
+        // only set while the camera is turned, otherwise the bounds nodes get are already tight
+        const ViewPolygon* m_clip;
+
+    public:
+        LineWriter(DrawGridAPI& api, float width)
+            : m_api(&api), m_buffer(&api.acquireLineBuffer(width, Mode)), m_width(width),
+              m_clip(api.getViewPolygon().rotated ? &api.getViewPolygon() : nullptr) {}
+
+        void reserve(size_t lines) {
+            const size_t needed = m_buffer->size() + lines * 2;
+            if (m_buffer->capacity() < needed) m_buffer->reserve(std::max(needed, m_buffer->capacity() * 2));
+        }
+
+        void drawLine(const cocos2d::ccVertex2F& start, const cocos2d::ccVertex2F& end, const LineColor& color) {
+            if (m_clip) {
+                cocos2d::ccVertex2F clippedStart = start;
+                cocos2d::ccVertex2F clippedEnd = end;
+                cocos2d::ccColor4B colorA = color.getColorA();
+                cocos2d::ccColor4B colorB = color.getColorB();
+                if (!m_clip->clipLine(clippedStart, clippedEnd, colorA, colorB, m_width)) return;
+                m_buffer->push_back({clippedStart, colorA, {}});
+                m_buffer->push_back({clippedEnd, colorB, {}});
+                return;
+            }
+            m_buffer->push_back({start, color.getColorA(), {}});
+            m_buffer->push_back({end, color.getColorB(), {}});
+        }
+
+        // switches buckets only when the width actually changes
+        void drawLine(const cocos2d::ccVertex2F& start, const cocos2d::ccVertex2F& end, const LineColor& color, float width) {
+            if (width != m_width) {
+                m_buffer = &m_api->acquireLineBuffer(width, Mode);
+                m_width = width;
+            }
+            drawLine(start, end, color);
+        }
+
+        float getWidth() const {
+            return m_width;
+        }
+    };
+
+    template <DrawMode Mode>
+    class RectWriter {
+        static_assert(Mode != DrawMode::NONE, "RectWriter needs a concrete draw mode");
+
+        DrawGridAPI* m_api;
+        std::vector<Vertex>* m_rectBuffer;
+        std::vector<Vertex>* m_outlineBuffer;
+
+    public:
+        RectWriter(DrawGridAPI& api)
+            : m_api(&api), m_rectBuffer(&api.acquireRectBuffer(Mode)), m_outlineBuffer(&api.acquireRectOutlineBuffer(Mode)) {}
+
+        void drawRect(const cocos2d::CCRect& rect, const cocos2d::ccColor4B& color) {
+            const auto triangles = m_api->rectToTriangles(rect, color);
+            m_rectBuffer->insert(m_rectBuffer->end(), triangles.begin(), triangles.end());
+        }
+
+        void drawRectOutline(const cocos2d::CCRect& rect, const cocos2d::ccColor4B& color, float width) {
+            const auto triangles = m_api->rectToBorderTriangles(rect, color, width);
+            m_outlineBuffer->insert(m_outlineBuffer->end(), triangles.begin(), triangles.end());
+        }
+    };
+
+    template <DrawMode Mode>
+    LineWriter<Mode> getLineWriter(float width) {
+        return LineWriter<Mode>(*this, width);
+    }
+
+    template <DrawMode Mode>
+    RectWriter<Mode> getRectWriter() {
+        return RectWriter<Mode>(*this);
+    }
+
+    /*
+        Collects full height vertical lines and draws one line per screen pixel column for each color and width,
+        so marker lines cost as much as the screen is wide no matter how dense they get. Lines that don't share
+        a column with anything else are drawn as they were. Scratch memory comes from the frame arena.
+    */
+    class GOOD_GRID_API_DLL ColumnAggregator {
+        struct Line {
+            float width;
+            int column;
+            float x;
+            cocos2d::ccColor4B colorA;
+            cocos2d::ccColor4B colorB;
+        };
+
+        DrawGridAPI* m_api;
+        float m_pixelsPerUnit;
+        ColumnAggregation m_mode;
+        FrameVector<Line> m_lines;
+
+    public:
+        ColumnAggregator(DrawGridAPI& api);
+
+        void drawLine(float x, const LineColor& color, float width);
+        // merges and draws everything added so far from minY to maxY
+        void flush(float minY, float maxY, DrawMode drawMode = DrawMode::NORMAL);
+
+        float getPixelsPerUnit() const {
+            return m_pixelsPerUnit;
+        }
+    };
+
+    /*
+        Lines and rects built on any thread and handed to submitBatch. Everything in here is drawn every
+        frame until a newer generation is submitted for the same channel.
+    */
+    struct DrawBatch {
+        struct Line {
+            cocos2d::ccVertex2F start;
+            cocos2d::ccVertex2F end;
+            LineColor color;
+            float width;
+            DrawMode drawMode;
+        };
+
+        struct Rect {
+            cocos2d::CCRect rect;
+            cocos2d::ccColor4B color;
+            // 0 for a filled rect
+            float outlineWidth;
+            DrawMode drawMode;
+        };
+
+        std::vector<Line> lines;
+        std::vector<Rect> rects;
+
+        void drawLine(const cocos2d::ccVertex2F& start, const cocos2d::ccVertex2F& end, const LineColor& color, float width, DrawMode drawMode = DrawMode::NORMAL) {
+            lines.push_back({start, end, color, width, drawMode});
+        }
+
+        void drawRect(const cocos2d::CCRect& rect, const cocos2d::ccColor4B& color, DrawMode drawMode = DrawMode::NORMAL) {
+            rects.push_back({rect, color, 0, drawMode});
+        }
+
+        void drawRectOutline(const cocos2d::CCRect& rect, const cocos2d::ccColor4B& color, float width, DrawMode drawMode = DrawMode::NORMAL) {
+            rects.push_back({rect, color, width, drawMode});
+        }
+    };
+
+    // what the profiler recorded for one frame
+    struct ProfilerFrame {
+        struct Node {
+            std::string id;
+            float cpuMs = 0;
+            uint32_t primitives = 0;
+            uint32_t callbacks = 0;
+        };
+
+        struct Bucket {
+            DrawMode drawMode;
+            PrimitiveKind kind;
+            float width;
+            uint32_t vertices;
+            // -1 until the GPU timer result comes in, or if GPU timing is off
+            float gpuMs = -1;
+        };
+
+        uint64_t frame = 0;
+        float totalMs = 0;
+        float gpuMs = -1;
+        uint32_t drawCalls = 0;
+        std::vector<Node> nodes;
+        std::vector<Bucket> buckets;
+    };
+
+    // what the geometry pass took out of the last frame's batch, each count is in primitives
+    struct GeometryStats {
+        // every vertex fully transparent
+        size_t transparent = 0;
+        // exactly the same as an opaque line drawn later
+        size_t duplicates = 0;
+        // joined with the line before them
+        size_t merged = 0;
+
+        size_t total() const {
+            return transparent + duplicates + merged;
+        }
+    };
+
+    struct StaticCacheStats {
+        // frames the cached layers came straight from the texture
+        size_t hits = 0;
+        // times the texture was drawn again
+        size_t renders = 0;
+    };
+
+    // a node the frame budget is drawing less often, reusing what it drew last in between
+    struct DegradedNode {
+        std::string id;
+        int level = 0;
+        // drawn every this many frames
+        int interval = 1;
+        float costMs = 0;
+    };
+
+    // averages over every frame still in the profiler's history
+    struct ProfilerSummary {
+        struct Node {
+            std::string id;
+            float averageMs = 0;
+            float p99Ms = 0;
+            float averagePrimitives = 0;
+            float averageCallbacks = 0;
+        };
+
+        size_t frames = 0;
+        float averageFrameMs = 0;
+        float p99FrameMs = 0;
+        // -1 if no recorded frame has GPU timings
+        float averageGPUMs = -1;
+        float p99GPUMs = -1;
+        float averageDrawCalls = 0;
+        float averageVertices = 0;
+        std::vector<Node> nodes;
+    };
+
+    // what the per frame batch buffers hold on to
+    struct MemoryStats {
+        struct Bucket {
+            DrawMode drawMode;
+            PrimitiveKind kind;
+            // 0 for rects and rect outlines
+            float width = 0;
+            // how much the last frame batched into it
+            size_t usedBytes = 0;
+            size_t reservedBytes = 0;
+        };
+
+        size_t usedBytes = 0;
+        size_t reservedBytes = 0;
+        // 0 if there's no budget
+        size_t budgetBytes = 0;
+        std::vector<Bucket> buckets;
+    };
+
+protected:
+    std::vector<Vertex>& acquireLineBuffer(float width, DrawMode drawMode);
+    std::vector<Vertex>& acquireRectBuffer(DrawMode drawMode);
+    std::vector<Vertex>& acquireRectOutlineBuffer(DrawMode drawMode);
+
+public:
+
     DrawGridAPI();
     ~DrawGridAPI();
     DrawGridAPI(const DrawGridAPI&) = delete;
@@ -70,7 +549,17 @@ public:
     DrawGridAPI(DrawGridAPI&&) noexcept;
     DrawGridAPI& operator=(DrawGridAPI&&) noexcept;
 
+    // the context drawing on this thread, otherwise the editor's
     static DrawGridAPI& get();
+    bool isMainContext();
+    // a new context with its own nodes and buffers sharing this one's level data, bound to the same DrawGridLayer
+    std::unique_ptr<DrawGridAPI> createContext();
+    // draws center at scale and angle into viewport, in the space of whatever node calls draw, instead of following the editor's camera
+    void setView(const cocos2d::CCRect& viewport, const cocos2d::CCPoint& center, float scale, float angle = 0);
+    void clearView();
+    bool hasOwnView();
+    // the zoom of this context's view, the editor's unless setView was used
+    float getViewScale();
 
     void init(DrawGridLayer* drawGridLayer, cocos2d::CCGLProgram* shader);
     void markDirty();
@@ -79,6 +568,8 @@ public:
     void setVanillaDraw(bool enabled);
     void setLineSmoothing(bool enabled);
     void setLineSmoothingLimit(float limit);
+    void setParallelDraw(bool enabled);
+    void setPipelinedDraw(bool enabled);
     void overrideGridBoundsSize(cocos2d::CCSize size);
     void overrideGridBoundsOrigin(cocos2d::CCPoint point);
     void generateTimeMarkers();
@@ -91,8 +582,29 @@ public:
     void drawRectV2(const cocos2d::CCRect& rect, const cocos2d::ccColor4B& color, DrawMode drawMode = DrawMode::NORMAL);
     void drawRectOutlineV2(const cocos2d::CCRect& rect, const cocos2d::ccColor4B& color, float width, DrawMode drawMode = DrawMode::NORMAL);
 
+    void drawVerticalLines(float originX, float spacing, int first, int last, float minY, float maxY, const LineColor& color, float width, DrawMode drawMode = DrawMode::NORMAL, int accentEvery = 0, const LineColor& accentColor = {});
+    void drawHorizontalLines(float originY, float spacing, int first, int last, float minX, float maxX, const LineColor& color, float width, DrawMode drawMode = DrawMode::NORMAL, int accentEvery = 0, const LineColor& accentColor = {});
+
     void setNextDrawMode(DrawMode drawMode);
 
+    // runs on the render thread right after this frame's batch is drawn, for drawing with your own shader
+    void addCustomDraw(std::function<void()> draw);
+    void submitBatch(const std::string& channel, uint64_t generation, DrawBatch batch);
+    void clearBatch(const std::string& channel);
+    uint64_t getFrameNumber();
+
+    PersistentHandle addPersistentLine(const cocos2d::ccVertex2F& start, const cocos2d::ccVertex2F& end, const LineColor& color, float width, DrawMode drawMode = DrawMode::NORMAL);
+    PersistentHandle addPersistentRect(const cocos2d::CCRect& rect, const cocos2d::ccColor4B& color, DrawMode drawMode = DrawMode::NORMAL);
+    PersistentHandle addPersistentRectOutline(const cocos2d::CCRect& rect, const cocos2d::ccColor4B& color, float width, DrawMode drawMode = DrawMode::NORMAL);
+    bool updatePersistentLine(const PersistentHandle& handle, const cocos2d::ccVertex2F& start, const cocos2d::ccVertex2F& end, const LineColor& color, float width, DrawMode drawMode = DrawMode::NORMAL);
+    bool updatePersistentRect(const PersistentHandle& handle, const cocos2d::CCRect& rect, const cocos2d::ccColor4B& color, DrawMode drawMode = DrawMode::NORMAL);
+    bool updatePersistentRectOutline(const PersistentHandle& handle, const cocos2d::CCRect& rect, const cocos2d::ccColor4B& color, float width, DrawMode drawMode = DrawMode::NORMAL);
+    bool removePersistent(const PersistentHandle& handle);
+    void clearPersistent();
+    size_t getPersistentCount();
+    // called from the editor hooks when the editor closes, the primitives are kept and uploaded again in the next one
+    void releasePersistentBuffers();
+
     void setInvertGrid(bool invert);
     bool invertGrid();
 
@@ -103,12 +615,78 @@ public:
     cocos2d::CCPoint getGridBoundsOrigin();
     cocos2d::CCPoint getPortalMinMax(GameObject* obj);
     std::unordered_map<float, cocos2d::ccColor4B> getTimeMarkers();
+    // the same without a copy, for going through them every frame
+    const std::unordered_map<float, cocos2d::ccColor4B>& getTimeMarkersRef();
+    // bumped whenever the time markers are generated again
+    uint64_t getTimeMarkersGeneration();
     cocos2d::CCSize getWorldViewSize();
+    // exactly what's on screen this frame, the bounds nodes get are this one's plus a few pixels
+    const ViewPolygon& getViewPolygon();
+    // how many screen pixels one unit of the level takes up at the current zoom
+    float getPixelsPerUnit();
     float getOverdrawFactor();
     float getLineSmoothingLimit();
+    const char* getLineKernelName();
     bool isDirty();
     bool isVanillaDraw();
+    bool isHideInvisible();
     bool hasLineSmoothing();
+    bool isParallelDraw();
+    bool isPipelinedDraw();
+    FrameTimings getFrameTimings();
+    void setMemoryBudget(size_t bytes);
+    size_t getMemoryBudget();
+    void setShrinkDelay(int frames);
+    MemoryStats getMemoryStats();
+    FrameArena& getFrameArena();
+    void setColumnAggregation(ColumnAggregation mode);
+    ColumnAggregation getColumnAggregation();
+    size_t getDrawLoopAllocations();
+    // drops invisible primitives and merges redundant lines from the batch before it's drawn, without changing how it looks
+    // on by default, and skipped while line smoothing is on since smoothed lines blend where they overlap
+    void setGeometryOptimization(bool enabled);
+    bool isGeometryOptimization();
+    GeometryStats getGeometryStats();
+    // draws the cacheable layers into a texture a bit bigger than the view and reuses it while panning
+    void setStaticCache(bool enabled);
+    bool isStaticCache();
+    // how much of the view's size is added on each side of the texture
+    void setStaticCacheMargin(float fraction);
+    float getStaticCacheMargin();
+    // for when a cached layer changed in a way the cache can't see, like a setting on one of them
+    void invalidateStaticCache();
+    StaticCacheStats getStaticCacheStats();
+    // how long drawing can take each frame before the least important nodes are drawn less often, 0 for no limit
+    void setFrameBudget(float ms);
+    float getFrameBudget();
+    // 0 while drawn every frame, otherwise it's drawn every 1 << level frames
+    int getDegradation(const DrawNode& drawNode);
+    std::vector<DegradedNode> getDegradedNodes();
+    // snapshots of the effect, duration and guide object arrays, brought up to date at the start of every frame
+    const TriggerTable& getEffectTriggers();
+    const TriggerTable& getDurationTriggers();
+    const TriggerTable& getGuideTriggers();
+    // called from the editor hooks, objects were added, removed or changed in a way that's not worth following one by one
+    void invalidateTriggerTables();
+    // called from the editor hooks, the object moved or its settings changed
+    void updateTrigger(GameObject* object);
+    void setProfiling(bool enabled);
+    bool isProfiling();
+    std::vector<ProfilerFrame> getProfilerHistory();
+    ProfilerSummary getProfilerSummary();
+    void clearProfilerHistory();
+    void setGPUTiming(bool enabled);
+    bool isGPUTiming();
+    bool isGPUTimingSupported();
+    void startTrace(size_t maxEvents = 100000);
+    geode::Result<std::filesystem::path> stopTrace(std::filesystem::path path = {});
+    bool isTracing();
+    geode::Result<std::vector<BenchmarkResult>> runBenchmark(const BenchmarkOptions& options = {});
+    geode::Result<std::vector<RenderBenchmarkResult>> runRenderBenchmark(int iterations = 30, int width = 1024);
+    void startCapture(int frames = 1);
+    bool isCapturing();
+    geode::Result<std::filesystem::path> stopCapture(std::filesystem::path path = {});
+    geode::Result<ReplayResult> replayCapture(const std::filesystem::path& path, size_t frame = 0, int width = 1024);
     bool isObjectVisible(GameObject* object);
     geode::Result<DrawNode&> getNodeByID(const std::string& id);
 
@@ -126,12 +704,27 @@ public:
     template <typename T>
     requires std::is_base_of_v<DrawNode, T>
     geode::Result<T&> getNode() {
-        for (const auto& drawNode : getDrawNodes()) {
-            if (auto casted = geode::cast::typeinfo_cast<T*>(drawNode.get())) {
-                return geode::Ok(*casted);
-            }
-        }
-        return geode::Err("Node not found with type");
+        DrawNode* drawNode = getNodeByType(typeid(T), [](DrawNode* node) {
+            return geode::cast::typeinfo_cast<T*>(node) != nullptr;
+        });
+        if (!drawNode) return geode::Err("Node not found with type");
+        return geode::Ok(*static_cast<T*>(drawNode));
+    }
+
+    template <typename T>
+    requires std::is_base_of_v<DrawNode, T>
+    NodeHandle<T> getNodeHandle(const std::string& id) {
+        auto result = getNode<T>(id);
+        if (!result) return NodeHandle<T>();
+        return NodeHandle<T>(&result.unwrap());
+    }
+
+    template <typename T>
+    requires std::is_base_of_v<DrawNode, T>
+    NodeHandle<T> getNodeHandle() {
+        auto result = getNode<T>();
+        if (!result) return NodeHandle<T>();
+        return NodeHandle<T>(&result.unwrap());
     }
 
     template <typename T, typename... Args>
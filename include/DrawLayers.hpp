@@ -3,6 +3,15 @@
 #include "DrawGridAPI.hpp"
 #include "PriorityCallbackList.hpp"
 
+class MarkerTexture;
+
+// a line outside what a marker texture covers, drawn as a line instead
+struct MarkerLine {
+    float m_x;
+    LineColor m_color;
+    float m_width;
+};
+
 #ifdef GEODE_IS_WINDOWS
     #ifdef GOOD_GRID_API_EXPORTING
         #define GOOD_GRID_API_DLL __declspec(dllexport)
@@ -18,7 +27,13 @@ class GOOD_GRID_API_DLL Grid : public DrawNode {
     int m_gridColorPriority = 0;
     float m_lineWidth = 1.0f;
     int m_lineWidthPriority = 0;
+    float m_lodSpacing = 0;
+    int m_lodSpacingPriority = 0;
+    int m_majorEvery = 0;
+    LineColor m_majorColor = { 0, 0, 0, 220 };
+    int m_majorLinesPriority = 0;
 
+    void init(DrawGridLayer* dgl) override;
     void draw(DrawGridLayer* dgl, float minX, float maxX, float minY, float maxY);
 public:
     void setGridColor(const LineColor& color, int priority = 0);
@@ -28,6 +43,17 @@ public:
     void setLineWidth(float width, int priority = 0);
     int getLineWidthPriority() const;
     float getLineWidth() const;
+
+    // the closest lines can get on screen before every other one is faded out, 0 draws every line
+    void setLODSpacing(float spacing, int priority = 0);
+    int getLODSpacingPriority() const;
+    float getLODSpacing() const;
+
+    // every Nth line in its own color, 0 for none
+    void setMajorLines(int every, const LineColor& color, int priority = 0);
+    int getMajorLinesPriority() const;
+    int getMajorLinesEvery() const;
+    const LineColor& getMajorLineColor() const;
 };
 
 class GOOD_GRID_API_DLL Bounds : public DrawNode {
@@ -115,9 +141,17 @@ public:
 class GOOD_GRID_API_DLL EffectLines : public DrawNode {
     using EffectLineCallback = std::function<void(LineColor& color, float& x, EffectGameObject* object, float& lineWidth)>;
     PriorityCallbackList<EffectLineCallback> m_colorsForObject;
+    bool m_textureMode = false;
+    std::shared_ptr<MarkerTexture> m_markerTexture;
+    std::vector<MarkerLine> m_outsideTexture;
+    void init(DrawGridLayer* dgl) override;
     void draw(DrawGridLayer* dgl, float minX, float maxX, float minY, float maxY);
 public:
     void setPropertiesForObject(EffectLineCallback colorForObject, int priority = 0);
+
+    // draws every line through a marker texture instead, only the first color of each line is used
+    void setTextureMode(bool enabled);
+    bool isTextureMode() const;
 };
 
 class GOOD_GRID_API_DLL DurationLines : public DrawNode {
@@ -132,9 +166,17 @@ public:
 class GOOD_GRID_API_DLL Guidelines : public DrawNode {
     using GuidelineCallback = std::function<void(LineColor& color, float& value, float& lineWidth)>;
     PriorityCallbackList<GuidelineCallback> m_colorsForValue;
+    bool m_textureMode = false;
+    std::shared_ptr<MarkerTexture> m_markerTexture;
+    std::vector<MarkerLine> m_outsideTexture;
+    void init(DrawGridLayer* dgl) override;
     void draw(DrawGridLayer* dgl, float minX, float maxX, float minY, float maxY);
 public:
     void setPropertiesForValue(GuidelineCallback colorForValue, int priority = 0);
+
+    // draws every line through a marker texture instead, only the first color of each line is used
+    void setTextureMode(bool enabled);
+    bool isTextureMode() const;
 };
 
 class GOOD_GRID_API_DLL BPMTriggers : public DrawNode {
@@ -213,4 +255,77 @@ public:
     int getLineWidthPriority() const;
 
     float getLineWidth() const;
-};
\ No newline at end of file
+};
+// a strip along the bottom of the view showing where triggers, duration lines and BPM beats are across the whole level
+class GOOD_GRID_API_DLL LevelOverview : public DrawNode {
+public:
+    static constexpr size_t COLUMNS = 1024;
+
+private:
+    struct Record {
+        float m_x;
+        float m_endX;
+        float m_weight;
+        uint32_t m_sweep;
+    };
+
+    struct Track {
+        std::unordered_map<const void*, Record> m_records;
+        std::array<float, COLUMNS> m_columns{};
+        size_t m_cursor = 0;
+        uint32_t m_sweep = 1;
+    };
+
+    Track m_triggers;
+    Track m_durations;
+    Track m_beats;
+    // level units per column, doubles whenever something lands past the last column
+    float m_columnWidth = 32.f;
+    bool m_shown = false;
+
+    LineColor m_triggerColor = { 0, 255, 255, 200 };
+    int m_triggerColorPriority = 0;
+    LineColor m_durationColor = { 160, 160, 160, 200 };
+    int m_durationColorPriority = 0;
+    LineColor m_beatColor = { 255, 200, 0, 200 };
+    int m_beatColorPriority = 0;
+    float m_height = 36.f;
+    int m_heightPriority = 0;
+
+    void init(DrawGridLayer* dgl) override;
+    void draw(DrawGridLayer* dgl, float minX, float maxX, float minY, float maxY);
+
+    void update(DrawGridLayer* dgl);
+    void visit(Track& track, const void* key, float x, float endX, float weight);
+    void endSweep(Track& track);
+    void addSpan(Track& track, float x, float endX, float weight);
+    void grow(float x);
+public:
+    // set by the Level Overview setting
+    void setShown(bool shown);
+    bool isShown() const;
+
+    // only the first color of each is used
+    void setTriggerColor(const LineColor& color, int priority = 0);
+    void setDurationColor(const LineColor& color, int priority = 0);
+    void setBeatColor(const LineColor& color, int priority = 0);
+    // in points
+    void setHeight(float height, int priority = 0);
+
+    int getTriggerColorPriority() const;
+    int getDurationColorPriority() const;
+    int getBeatColorPriority() const;
+    int getHeightPriority() const;
+
+    const LineColor& getTriggerColor() const;
+    const LineColor& getDurationColor() const;
+    const LineColor& getBeatColor() const;
+    float getHeight() const;
+
+    // level units covered by each histogram column
+    float getColumnWidth() const;
+    // how many triggers, units of duration lines and BPM beats fall in each column
+    const std::array<float, COLUMNS>& getTriggerDensity() const;
+    const std::array<float, COLUMNS>& getDurationDensity() const;
+    const std::array<float, COLUMNS>& getBeatDensity() const;
+};
@@ -16,9 +16,13 @@
 using DrawFunc = std::function<void(DrawGridLayer*, float, float, float, float)>;
 
 struct DrawNodeImpl;
+class DrawGridAPI;
 
 class GOOD_GRID_API_DLL DrawNode {
     std::unique_ptr<DrawNodeImpl> m_impl;
+
+    friend class DrawGridAPI;
+    void setAPI(DrawGridAPI* api);
 public:
     DrawNode();
     DrawNode(const std::string& id);
@@ -29,11 +33,32 @@ public:
     virtual ~DrawNode();
 
     std::string getID() const;
+    // the same without a copy, for looking nodes up every frame
+    const std::string& getIDRef() const;
     bool isEnabled() const;
     int getZOrder() const;
     void setZOrder(int order);
     void setEnabled(bool enabled);
     void setID(const std::string& id);
+    void setThreadSafe(bool threadSafe);
+    // grows the bounds this node is drawn with by this many units on every side, for things that reach past where they're culled
+    void setCullingMargin(float margin);
+    float getCullingMargin() const;
+    // under a frame budget, lower priority nodes are the first to be drawn less often
+    void setBudgetPriority(int priority);
+    int getBudgetPriority() const;
+    bool isThreadSafe() const;
+    // only draws what the level looks like, so it can come from the static cache instead of being drawn every frame
+    void setCacheable(bool cacheable);
+    bool isCacheable() const;
     virtual void init(DrawGridLayer* drawGridLayer);
     virtual void draw(DrawGridLayer* drawGridLayer, float minX, float maxX, float minY, float maxY);
+    // how many callbacks this node has run since it was added, for the profiler
+    size_t getCallbackCount() const;
+protected:
+    void countCallbacks(size_t count);
+    // for subclasses doing something that has to stay on the render thread whatever setThreadSafe was given, like running callbacks from other mods
+    void setRenderThreadOnly(bool renderThreadOnly);
+    // same for setCacheable, for while what the subclass draws depends on more than the level
+    void setAlwaysLive(bool alwaysLive);
 };
\ No newline at end of file
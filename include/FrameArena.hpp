@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "DrawNode.hpp"
+
+/*
+    Bump allocator for scratch memory while drawing. Nothing is freed on its own, everything goes at once
+    when the arena is reset after the frame's batch is built, so don't keep anything from it past the draw
+    call that allocated it.
+*/
+class GOOD_GRID_API_DLL FrameArena {
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    struct Block {
+        std::unique_ptr<std::byte[]> m_data;
+        size_t m_size = 0;
+    };
+
+    std::vector<Block> m_blocks;
+    size_t m_block = 0;
+    size_t m_offset = 0;
+    size_t m_used = 0;
+
+public:
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+    // frees everything, if the frame needed more than one block they're merged so the next one doesn't
+    void reset();
+    size_t getUsedBytes() const;
+    size_t getReservedBytes() const;
+};
+
+template <typename T>
+class FrameAllocator {
+    FrameArena* m_arena;
+
+public:
+    using value_type = T;
+
+    FrameAllocator(FrameArena& arena) : m_arena(&arena) {}
+
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>& other) : m_arena(other.getArena()) {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(m_arena->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t) {}
+
+    FrameArena* getArena() const {
+        return m_arena;
+    }
+
+    template <typename U>
+    bool operator==(const FrameAllocator<U>& other) const {
+        return m_arena == other.getArena();
+    }
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
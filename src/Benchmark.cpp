@@ -0,0 +1,297 @@
+#include "../include/DrawGridAPI.hpp"
+#include "DrawGridAPIImpl.hpp"
+#include <chrono>
+#include <numeric>
+#include <random>
+#include <Geode/Geode.hpp>
+
+using namespace geode::prelude;
+
+struct BenchmarkView {
+    float minX;
+    float maxX;
+    float minY;
+    float maxY;
+    float overdrawFactor;
+    CCSize worldViewSize;
+    ViewPolygon polygon;
+};
+
+// the same bounds draw() would use if the editor were at this zoom and rotation
+static BenchmarkView viewFor(DrawGridAPIImpl& impl, float zoom, float rotation) {
+    const CCSize winSize = CCDirector::get()->getWinSize();
+    const float rotationRad = CC_DEGREES_TO_RADIANS(rotation);
+
+    BenchmarkView view;
+    view.overdrawFactor = std::max(winSize.width / winSize.height, std::abs(std::sin(rotationRad)) + std::abs(std::cos(rotationRad)) * 2.f);
+    view.worldViewSize = winSize / zoom * view.overdrawFactor;
+
+    ViewCamera camera = currentCamera(impl);
+    camera.m_scale = zoom;
+    camera.m_angle = rotation;
+    view.polygon = computeViewPolygon(camera);
+
+    const CCRect bounds = viewBounds(impl, view.polygon);
+    view.minX = bounds.getMinX();
+    view.maxX = bounds.getMaxX();
+    view.minY = bounds.getMinY();
+    view.maxY = bounds.getMaxY();
+    return view;
+}
+
+static std::unordered_map<float, ccColor4B> syntheticTimeMarkers(const BenchmarkView& view, size_t count) {
+    static const ccColor4B colors[] = {{255, 255, 0, 255}, {127, 255, 0, 255}, {255, 127, 0, 255}};
+
+    // seeded so runs can be compared against each other
+    std::mt19937 random(count);
+    std::uniform_real_distribution<float> position(view.minX, view.maxX);
+
+    std::unordered_map<float, ccColor4B> markers;
+    markers.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        markers[position(random)] = colors[i % 3];
+    }
+    return markers;
+}
+
+Result<std::vector<BenchmarkResult>> DrawGridAPI::runBenchmark(const BenchmarkOptions& options) {
+    if (!m_impl->m_drawGridLayer || !LevelEditorLayer::get()) return Err("Benchmarks can only run in the editor");
+    if (options.iterations <= 0) return Err("Benchmarks need at least one iteration");
+    if (m_impl->m_shouldSort) sort();
+
+    // nodes read these while drawing, so they're swapped out for each view and put back afterwards
+    const auto savedWorldViewSize = m_impl->m_cachedWorldViewSize;
+    const auto savedOverdrawFactor = m_impl->m_cachedOverdrawFactor;
+    const auto savedViewPolygon = m_impl->m_viewPolygon;
+    auto savedTimeMarkers = m_impl->m_level->m_timeMarkers;
+
+    VertexBuffers scratch;
+    TargetBuffersScope scope(&scratch);
+    CurrentContextScope context(this);
+    std::vector<BenchmarkResult> results;
+
+    for (float zoom : options.zooms) {
+        for (float rotation : options.rotations) {
+            if (zoom <= 0) continue;
+            const auto view = viewFor(*m_impl, zoom, rotation);
+            m_impl->m_cachedWorldViewSize = view.worldViewSize;
+            m_impl->m_cachedOverdrawFactor = view.overdrawFactor;
+            m_impl->m_viewPolygon = view.polygon;
+
+            if (options.syntheticTimeMarkers > 0) {
+                m_impl->m_level->m_timeMarkers = savedTimeMarkers;
+                m_impl->m_level->m_timeMarkers.merge(syntheticTimeMarkers(view, options.syntheticTimeMarkers));
+            }
+
+            std::vector<float> frameMs;
+            std::vector<std::vector<float>> nodeMs(m_impl->m_drawNodes.size());
+            std::vector<size_t> nodePrimitives(m_impl->m_drawNodes.size());
+
+            for (int iteration = 0; iteration < options.iterations; ++iteration) {
+                const auto frameStart = std::chrono::steady_clock::now();
+
+                for (size_t i = 0; i < m_impl->m_drawNodes.size(); ++i) {
+                    auto& drawNode = m_impl->m_drawNodes[i];
+                    if (!drawNode->isEnabled()) continue;
+
+                    float minX = view.minX, maxX = view.maxX, minY = view.minY, maxY = view.maxY;
+                    growBoundsForNode(*m_impl, *drawNode, minX, maxX, minY, maxY);
+
+                    const auto start = std::chrono::steady_clock::now();
+                    drawNode->draw(m_impl->m_drawGridLayer, minX, maxX, minY, maxY);
+                    const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+                    nodeMs[i].push_back(elapsed.count());
+                    nodePrimitives[i] = scratch.primitiveCount();
+                    scratch.reset();
+                }
+
+                const std::chrono::duration<float, std::milli> frameElapsed = std::chrono::steady_clock::now() - frameStart;
+                frameMs.push_back(frameElapsed.count());
+            }
+
+            BenchmarkResult result;
+            result.zoom = zoom;
+            result.rotation = rotation;
+            result.averageMs = std::accumulate(frameMs.begin(), frameMs.end(), 0.f) / frameMs.size();
+            result.p99Ms = percentile99(frameMs);
+
+            for (size_t i = 0; i < m_impl->m_drawNodes.size(); ++i) {
+                if (nodeMs[i].empty()) continue;
+                result.nodes.push_back({
+                    m_impl->m_drawNodes[i]->getID(),
+                    std::accumulate(nodeMs[i].begin(), nodeMs[i].end(), 0.f) / nodeMs[i].size(),
+                    percentile99(nodeMs[i]),
+                    static_cast<uint32_t>(nodePrimitives[i])
+                });
+            }
+
+            log::info("Benchmark zoom {} rotation {}: {:.3f}ms avg, {:.3f}ms p99", zoom, rotation, result.averageMs, result.p99Ms);
+            for (const auto& node : result.nodes) {
+                log::info("  {}: {:.3f}ms avg, {:.3f}ms p99, {} primitives", node.id, node.averageMs, node.p99Ms, node.primitives);
+            }
+            results.push_back(std::move(result));
+        }
+    }
+
+    m_impl->m_cachedWorldViewSize = savedWorldViewSize;
+    m_impl->m_cachedOverdrawFactor = savedOverdrawFactor;
+    m_impl->m_viewPolygon = savedViewPolygon;
+    m_impl->m_level->m_timeMarkers = std::move(savedTimeMarkers);
+    m_impl->m_dirtyViewTransform = true;
+
+    return Ok(std::move(results));
+}
+
+struct RenderScenario {
+    const char* name;
+    DrawGridAPI::DrawMode drawMode;
+    float lineWidth;
+    bool smoothing;
+    float rotation;
+};
+
+static constexpr RenderScenario RENDER_SCENARIOS[] = {
+    {"normal", DrawGridAPI::DrawMode::NORMAL, 1, false, 0},
+    {"blended", DrawGridAPI::DrawMode::BLEND, 1, false, 0},
+    {"inverted", DrawGridAPI::DrawMode::INVERT, 1, false, 0},
+    {"smoothed", DrawGridAPI::DrawMode::NORMAL, 1, true, 0},
+    {"large widths", DrawGridAPI::DrawMode::NORMAL, 8, false, 0},
+    {"rotated", DrawGridAPI::DrawMode::NORMAL, 1, false, 45},
+};
+
+static constexpr const char* RENDER_BENCHMARK_CHANNEL = "good-grid/render-benchmark";
+
+// drawn on top of the level so every scenario exercises its draw mode and width even on an empty level
+static DrawGridAPI::DrawBatch scenarioBatch(const RenderScenario& scenario, const BenchmarkView& view) {
+    static constexpr int LINES = 64;
+    static constexpr int RECTS = 32;
+
+    DrawGridAPI::DrawBatch batch;
+    const float stepX = (view.maxX - view.minX) / LINES;
+    const float stepY = (view.maxY - view.minY) / LINES;
+    for (int i = 0; i < LINES; ++i) {
+        const float x = view.minX + stepX * i;
+        const float y = view.minY + stepY * i;
+        const GLubyte shade = static_cast<GLubyte>(i * 4);
+        batch.drawLine({x, view.minY}, {x, view.maxY}, {255, shade, 0, 160}, scenario.lineWidth, scenario.drawMode);
+        batch.drawLine({view.minX, y}, {view.maxX, y}, {{0, shade, 255, 160}, {255, 255, 255, 160}}, scenario.lineWidth, scenario.drawMode);
+    }
+
+    std::mt19937 random(RECTS);
+    std::uniform_real_distribution<float> x(view.minX, view.maxX);
+    std::uniform_real_distribution<float> y(view.minY, view.maxY);
+    std::uniform_real_distribution<float> size(30, 240);
+    for (int i = 0; i < RECTS; ++i) {
+        const CCRect rect{x(random), y(random), size(random), size(random)};
+        if (i % 2) batch.drawRectOutline(rect, {0, 255, 127, 200}, scenario.lineWidth, scenario.drawMode);
+        else batch.drawRect(rect, {127, 0, 255, 100}, scenario.drawMode);
+    }
+    return batch;
+}
+
+static uint64_t checksumPixels(const std::vector<GLubyte>& pixels) {
+    uint64_t hash = 0xcbf29ce484222325;
+    for (GLubyte byte : pixels) {
+        hash ^= byte;
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+Result<std::vector<RenderBenchmarkResult>> DrawGridAPI::runRenderBenchmark(int iterations, int width) {
+    if (!m_impl->m_drawGridLayer || !LevelEditorLayer::get()) return Err("Benchmarks can only run in the editor");
+    if (m_impl->m_vanillaDraw) return Err("Render benchmarks need Good Grid's own drawing");
+    if (iterations <= 0) return Err("Benchmarks need at least one iteration");
+
+    const CCSize winSize = CCDirector::get()->getWinSize();
+    const int height = std::max(1, static_cast<int>(width * winSize.height / winSize.width));
+    auto texture = CCRenderTexture::create(width, height);
+    if (!texture) return Err("Could not create a render texture");
+
+    const auto editorLayer = m_impl->m_drawGridLayer->m_editorLayer;
+    const auto objectLayer = editorLayer->m_objectLayer;
+
+    const CCPoint savedPosition = objectLayer->getPosition();
+    const float savedScale = objectLayer->getScale();
+    const float savedCameraAngle = editorLayer->m_gameState.m_cameraAngle;
+    const bool savedSmoothing = m_impl->m_lineSmoothing;
+    const float savedSmoothingLimit = m_impl->m_lineSmoothingLimit;
+    const bool savedInvertGrid = m_impl->m_invertGrid;
+    const bool savedPipelined = m_impl->m_pipelinedDraw;
+    const bool savedProfiling = m_impl->m_profiler.m_enabled;
+
+    // a fixed camera so the checksums only depend on the level and the window size
+    objectLayer->setScale(1);
+    objectLayer->setPosition(-CCPoint{winSize.width * 0.5f, winSize.height * 0.5f});
+    // a pipelined frame would show the previous scenario, and these frames shouldn't end up in the profiler
+    setPipelinedDraw(false);
+    m_impl->m_profiler.m_enabled = false;
+
+    std::vector<GLubyte> pixels(static_cast<size_t>(width) * height * 4);
+    std::vector<RenderBenchmarkResult> results;
+    uint64_t generation = 0;
+
+    for (const auto& scenario : RENDER_SCENARIOS) {
+        m_impl->m_lineSmoothing = scenario.smoothing;
+        m_impl->m_lineSmoothingLimit = 0;
+        m_impl->m_invertGrid = scenario.drawMode == DrawMode::INVERT;
+        editorLayer->m_gameState.m_cameraAngle = scenario.rotation;
+        m_impl->m_dirtyViewTransform = true;
+        submitBatch(RENDER_BENCHMARK_CHANNEL, ++generation, scenarioBatch(scenario, viewFor(*m_impl, 1, scenario.rotation)));
+
+        std::vector<float> frameMs;
+        RenderBenchmarkResult result;
+        result.scenario = scenario.name;
+
+        // the first frame picks up the batch and warms the buffers up, it isn't timed
+        for (int iteration = 0; iteration <= iterations; ++iteration) {
+            texture->beginWithClear(0, 0, 0, 0);
+
+            kmGLMatrixMode(KM_GL_MODELVIEW);
+            kmGLPushMatrix();
+            kmGLLoadIdentity();
+            // the editor rotates the whole view around the middle of the screen
+            kmGLTranslatef(winSize.width * 0.5f, winSize.height * 0.5f, 0);
+            kmGLRotatef(-scenario.rotation, 0, 0, 1);
+            kmGLTranslatef(-winSize.width * 0.5f, -winSize.height * 0.5f, 0);
+
+            CCAffineTransform nodeToWorld = m_impl->m_drawGridLayer->nodeToWorldTransform();
+            kmMat4 transform;
+            CGAffineToGL(&nodeToWorld, transform.mat);
+            kmGLMultMatrix(&transform);
+
+            const auto start = std::chrono::steady_clock::now();
+            draw();
+            glFinish();
+            const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            if (iteration > 0) frameMs.push_back(elapsed.count());
+
+            if (iteration == iterations) {
+                glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+                result.checksum = checksumPixels(pixels);
+            }
+
+            kmGLPopMatrix();
+            texture->end();
+        }
+
+        result.averageMs = std::accumulate(frameMs.begin(), frameMs.end(), 0.f) / frameMs.size();
+        result.p99Ms = percentile99(frameMs);
+        log::info("Render benchmark {}: {:.3f}ms avg, {:.3f}ms p99, checksum {:016x}", result.scenario, result.averageMs, result.p99Ms, result.checksum);
+        results.push_back(std::move(result));
+    }
+
+    clearBatch(RENDER_BENCHMARK_CHANNEL);
+    objectLayer->setScale(savedScale);
+    objectLayer->setPosition(savedPosition);
+    editorLayer->m_gameState.m_cameraAngle = savedCameraAngle;
+    m_impl->m_lineSmoothing = savedSmoothing;
+    m_impl->m_lineSmoothingLimit = savedSmoothingLimit;
+    m_impl->m_invertGrid = savedInvertGrid;
+    m_impl->m_profiler.m_enabled = savedProfiling;
+    setPipelinedDraw(savedPipelined);
+    m_impl->m_dirtyViewTransform = true;
+
+    return Ok(std::move(results));
+}
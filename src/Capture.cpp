@@ -0,0 +1,207 @@
+#include "../include/DrawGridAPI.hpp"
+#include "DrawGridAPIImpl.hpp"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include <Geode/Geode.hpp>
+
+using namespace geode::prelude;
+
+static constexpr char CAPTURE_MAGIC[4] = {'G', 'G', 'C', 'P'};
+static constexpr uint32_t CAPTURE_VERSION = 1;
+
+/*
+    Layout, all little endian:
+    magic, version, frame count
+    per frame: frame number, bounds (x, y, width, height), bucket count
+    per bucket: draw mode, primitive kind, width, vertex count, then the vertices exactly as they're sent to GL
+*/
+
+template <typename T>
+static void writeValue(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+static bool readValue(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+void captureFrame(DrawGridAPIImpl& impl) {
+    auto& capture = impl.m_capture;
+    auto& frame = capture.m_frames.emplace_back();
+    frame.m_frame = impl.m_frameNumber.load(std::memory_order_relaxed);
+    frame.m_bounds = impl.m_visibleRect;
+
+    auto captureBucket = [&](DrawGridAPI::DrawMode drawMode, PrimitiveKind kind, float width, const std::vector<Vertex>& vertices) {
+        if (!vertices.empty()) frame.m_buckets.push_back({drawMode, kind, width, vertices});
+    };
+
+    for (auto drawMode : {DrawGridAPI::DrawMode::INVERT, DrawGridAPI::DrawMode::NORMAL, DrawGridAPI::DrawMode::BLEND}) {
+        for (const auto& [width, vertices] : impl.m_buffers.lineBuckets(drawMode)) {
+            captureBucket(drawMode, PrimitiveKind::LINE, width, vertices);
+        }
+        captureBucket(drawMode, PrimitiveKind::RECT, 0, impl.m_buffers.rects(drawMode));
+        captureBucket(drawMode, PrimitiveKind::RECT_OUTLINE, 0, impl.m_buffers.rectOutlines(drawMode));
+    }
+    capturePersistentPrimitives(impl, frame);
+
+    --capture.m_remaining;
+}
+
+void DrawGridAPI::startCapture(int frames) {
+    m_impl->m_capture.m_frames.clear();
+    m_impl->m_capture.m_remaining = std::max(frames, 1);
+}
+
+bool DrawGridAPI::isCapturing() {
+    return m_impl->m_capture.m_remaining > 0;
+}
+
+Result<std::filesystem::path> DrawGridAPI::stopCapture(std::filesystem::path path) {
+    auto& capture = m_impl->m_capture;
+    capture.m_remaining = 0;
+    if (capture.m_frames.empty()) return Err("Nothing was captured");
+
+    if (path.empty()) {
+        const auto now = std::chrono::system_clock::now().time_since_epoch();
+        path = Mod::get()->getSaveDir() / fmt::format("capture-{}.ggcap", std::chrono::duration_cast<std::chrono::seconds>(now).count());
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) return Err("Could not open capture file for writing");
+
+    file.write(CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+    writeValue(file, CAPTURE_VERSION);
+    writeValue(file, static_cast<uint32_t>(capture.m_frames.size()));
+
+    for (const auto& frame : capture.m_frames) {
+        writeValue(file, frame.m_frame);
+        writeValue(file, frame.m_bounds.origin.x);
+        writeValue(file, frame.m_bounds.origin.y);
+        writeValue(file, frame.m_bounds.size.width);
+        writeValue(file, frame.m_bounds.size.height);
+        writeValue(file, static_cast<uint32_t>(frame.m_buckets.size()));
+
+        for (const auto& bucket : frame.m_buckets) {
+            writeValue(file, static_cast<int8_t>(bucket.m_drawMode));
+            writeValue(file, static_cast<uint8_t>(bucket.m_kind));
+            writeValue(file, bucket.m_width);
+            writeValue(file, static_cast<uint32_t>(bucket.m_vertices.size()));
+            file.write(reinterpret_cast<const char*>(bucket.m_vertices.data()), bucket.m_vertices.size() * sizeof(Vertex));
+        }
+    }
+
+    capture.m_frames.clear();
+    if (!file) return Err("Could not write capture file");
+    return Ok(path);
+}
+
+static Result<CapturedFrame> loadCapturedFrame(const std::filesystem::path& path, size_t index) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return Err("Could not open capture file");
+
+    char magic[4];
+    uint32_t version, frameCount;
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, CAPTURE_MAGIC, sizeof(magic)) != 0) return Err("Not a capture file");
+    if (!readValue(file, version) || version != CAPTURE_VERSION) return Err("Unsupported capture version");
+    if (!readValue(file, frameCount) || index >= frameCount) return Err("Capture doesn't have that many frames");
+
+    CapturedFrame frame;
+    for (size_t i = 0; i <= index; ++i) {
+        uint32_t bucketCount;
+        bool ok = readValue(file, frame.m_frame)
+            && readValue(file, frame.m_bounds.origin.x)
+            && readValue(file, frame.m_bounds.origin.y)
+            && readValue(file, frame.m_bounds.size.width)
+            && readValue(file, frame.m_bounds.size.height)
+            && readValue(file, bucketCount);
+        if (!ok) return Err("Capture file is truncated");
+
+        frame.m_buckets.clear();
+        for (uint32_t b = 0; b < bucketCount; ++b) {
+            int8_t drawMode;
+            uint8_t kind;
+            float width;
+            uint32_t vertexCount;
+            ok = readValue(file, drawMode) && readValue(file, kind) && readValue(file, width) && readValue(file, vertexCount);
+            if (!ok) return Err("Capture file is truncated");
+
+            // frames before the wanted one only need skipping over
+            if (i < index) {
+                file.seekg(static_cast<std::streamoff>(vertexCount) * sizeof(Vertex), std::ios::cur);
+                continue;
+            }
+
+            auto& bucket = frame.m_buckets.emplace_back();
+            bucket.m_drawMode = static_cast<DrawGridAPI::DrawMode>(drawMode);
+            bucket.m_kind = static_cast<PrimitiveKind>(kind);
+            bucket.m_width = width;
+            bucket.m_vertices.resize(vertexCount);
+            if (!file.read(reinterpret_cast<char*>(bucket.m_vertices.data()), vertexCount * sizeof(Vertex))) return Err("Capture file is truncated");
+        }
+    }
+    return Ok(std::move(frame));
+}
+
+Result<ReplayResult> DrawGridAPI::replayCapture(const std::filesystem::path& path, size_t frameIndex, int width) {
+    GEODE_UNWRAP_INTO(auto frame, loadCapturedFrame(path, frameIndex));
+    if (frame.m_bounds.size.width <= 0 || frame.m_bounds.size.height <= 0) return Err("Captured frame has no visible area");
+
+    VertexBuffers buffers;
+    ReplayResult result;
+    for (auto& bucket : frame.m_buckets) {
+        std::vector<Vertex>* target;
+        switch (bucket.m_kind) {
+            case PrimitiveKind::LINE: target = &buffers.lines(bucket.m_drawMode, bucket.m_width); break;
+            case PrimitiveKind::RECT: target = &buffers.rects(bucket.m_drawMode); break;
+            default: target = &buffers.rectOutlines(bucket.m_drawMode); break;
+        }
+        if (target->empty()) ++result.drawCalls;
+        target->insert(target->end(), bucket.m_vertices.begin(), bucket.m_vertices.end());
+        result.vertices += bucket.m_vertices.size();
+    }
+
+    const int height = std::max(1, static_cast<int>(width * frame.m_bounds.size.height / frame.m_bounds.size.width));
+    result.texture = CCRenderTexture::create(width, height);
+    if (!result.texture) return Err("Could not create a render texture");
+
+    auto shader = CCShaderCache::sharedShaderCache()->programForKey(kCCShader_PositionColor);
+    const CCSize winSize = CCDirector::get()->getWinSize();
+
+    GLint oldSrc, oldDst;
+    glGetIntegerv(GL_BLEND_SRC_ALPHA, &oldSrc);
+    glGetIntegerv(GL_BLEND_DST_ALPHA, &oldDst);
+    // the replay isn't part of any frame, so keep it out of the frame's GPU timings
+    const bool gpuTimersActive = std::exchange(m_impl->m_gpuTimers.m_active, false);
+
+    result.texture->beginWithClear(0, 0, 0, 0);
+
+    // the render texture maps the window onto itself, so squeeze the captured bounds into the window
+    kmGLMatrixMode(KM_GL_MODELVIEW);
+    kmGLPushMatrix();
+    kmGLLoadIdentity();
+    kmGLScalef(winSize.width / frame.m_bounds.size.width, winSize.height / frame.m_bounds.size.height, 1);
+    kmGLTranslatef(-frame.m_bounds.origin.x, -frame.m_bounds.origin.y, 0);
+
+    shader->use();
+    shader->setUniformsForBuiltins();
+    ccGLEnableVertexAttribs(kCCVertexAttribFlag_Position | kCCVertexAttribFlag_Color);
+
+    const auto start = std::chrono::steady_clock::now();
+    submitBuffers(*m_impl, buffers, 0, false);
+    // replays are for measuring, so wait for the GPU to actually finish
+    glFinish();
+    const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    result.submitMs = elapsed.count();
+
+    glLineWidth(1);
+    kmGLPopMatrix();
+    result.texture->end();
+
+    m_impl->m_gpuTimers.m_active = gpuTimersActive;
+    ccGLBlendFunc(oldSrc, oldDst);
+
+    return Ok(result);
+}
@@ -0,0 +1,79 @@
+#include "../include/DrawGridAPI.hpp"
+#include "DrawGridAPIImpl.hpp"
+#include <algorithm>
+#include <tuple>
+#include <Geode/Geode.hpp>
+
+using namespace geode::prelude;
+
+// alpha is left out, lines that only differ in it still get merged
+static auto sortKey(const auto& line) {
+    return std::tie(line.width, line.column, line.colorA.r, line.colorA.g, line.colorA.b, line.colorB.r, line.colorB.g, line.colorB.b);
+}
+
+DrawGridAPI::ColumnAggregator::ColumnAggregator(DrawGridAPI& api)
+    : m_api(&api), m_pixelsPerUnit(api.getPixelsPerUnit()), m_mode(api.m_impl->m_columnAggregation), m_lines(FrameAllocator<Line>(api.getFrameArena())) {}
+
+void DrawGridAPI::ColumnAggregator::drawLine(float x, const LineColor& color, float width) {
+    m_lines.push_back({width, static_cast<int>(std::floor(x * m_pixelsPerUnit)), x, color.getColorA(), color.getColorB()});
+}
+
+void DrawGridAPI::ColumnAggregator::flush(float minY, float maxY, DrawMode drawMode) {
+    if (m_mode != ColumnAggregation::OFF) {
+        std::sort(m_lines.begin(), m_lines.end(), [](const Line& a, const Line& b) {
+            return sortKey(a) < sortKey(b);
+        });
+    }
+
+    std::vector<Vertex>* buffer = nullptr;
+    float bufferWidth = 0;
+    const ViewPolygon& view = m_api->getViewPolygon();
+
+    for (size_t i = 0; i < m_lines.size();) {
+        const Line& first = m_lines[i];
+        float alphaA = first.colorA.a / 255.f;
+        float alphaB = first.colorB.a / 255.f;
+
+        size_t next = i + 1;
+        while (m_mode != ColumnAggregation::OFF && next < m_lines.size() && sortKey(m_lines[next]) == sortKey(first)) {
+            const float nextA = m_lines[next].colorA.a / 255.f;
+            const float nextB = m_lines[next].colorB.a / 255.f;
+            if (m_mode == ColumnAggregation::MAX_ALPHA) {
+                alphaA = std::max(alphaA, nextA);
+                alphaB = std::max(alphaB, nextB);
+            }
+            else {
+                alphaA += nextA - alphaA * nextA;
+                alphaB += nextB - alphaB * nextB;
+            }
+            ++next;
+        }
+
+        if (!buffer || bufferWidth != first.width) {
+            buffer = &m_api->acquireLineBuffer(first.width, drawMode);
+            bufferWidth = first.width;
+        }
+
+        ccColor4B colorA = first.colorA;
+        ccColor4B colorB = first.colorB;
+        colorA.a = static_cast<GLubyte>(alphaA * 255.f + 0.5f);
+        colorB.a = static_cast<GLubyte>(alphaB * 255.f + 0.5f);
+        ccVertex2F start = {first.x, minY};
+        ccVertex2F end = {first.x, maxY};
+        if (!view.rotated || view.clipLine(start, end, colorA, colorB, first.width)) {
+            buffer->push_back({start, colorA});
+            buffer->push_back({end, colorB});
+        }
+
+        i = next;
+    }
+    m_lines.clear();
+}
+
+void DrawGridAPI::setColumnAggregation(ColumnAggregation mode) {
+    m_impl->m_columnAggregation = mode;
+}
+
+DrawGridAPI::ColumnAggregation DrawGridAPI::getColumnAggregation() {
+    return m_impl->m_columnAggregation;
+}
@@ -0,0 +1,68 @@
+#include "../include/DrawGridAPI.hpp"
+#include "DrawGridAPIImpl.hpp"
+#include <Geode/Geode.hpp>
+
+using namespace geode::prelude;
+
+static thread_local DrawGridAPI* t_currentContext = nullptr;
+
+CurrentContextScope::CurrentContextScope(DrawGridAPI* api) : m_previous(t_currentContext) {
+    t_currentContext = api;
+}
+
+CurrentContextScope::~CurrentContextScope() {
+    t_currentContext = m_previous;
+}
+
+static DrawGridAPI& mainContext() {
+    static DrawGridAPI instance;
+    return instance;
+}
+
+DrawGridAPI& DrawGridAPI::get() {
+    return t_currentContext ? *t_currentContext : mainContext();
+}
+
+bool DrawGridAPI::isMainContext() {
+    return this == &mainContext();
+}
+
+/*
+    The new context gets its own nodes, buffers, workers and settings, only what's worked out from the
+    level is shared, so time markers are generated once no matter how many contexts draw them.
+*/
+std::unique_ptr<DrawGridAPI> DrawGridAPI::createContext() {
+    auto context = std::make_unique<DrawGridAPI>();
+    context->m_impl->m_level = m_impl->m_level;
+    context->m_impl->m_gridWidthMin = m_impl->m_gridWidthMin;
+    context->m_impl->m_gridHeightMin = m_impl->m_gridHeightMin;
+    context->m_impl->m_gridWidthMax = m_impl->m_gridWidthMax;
+    context->m_impl->m_gridHeightMax = m_impl->m_gridHeightMax;
+    if (m_impl->m_drawGridLayer) context->init(m_impl->m_drawGridLayer, m_impl->m_shader);
+    return context;
+}
+
+void DrawGridAPI::setView(const CCRect& viewport, const CCPoint& center, float scale, float angle) {
+    auto& view = m_impl->m_view;
+    view.m_enabled = true;
+    view.m_viewport = viewport;
+    view.m_center = center;
+    view.m_scale = scale;
+    view.m_angle = angle;
+    m_impl->m_dirtyViewTransform = true;
+}
+
+void DrawGridAPI::clearView() {
+    m_impl->m_view.m_enabled = false;
+    m_impl->m_dirtyViewTransform = true;
+}
+
+bool DrawGridAPI::hasOwnView() {
+    return m_impl->m_view.m_enabled;
+}
+
+float DrawGridAPI::getViewScale() {
+    if (m_impl->m_frameView.m_active) return m_impl->m_frameView.m_camera.m_scale;
+    if (m_impl->m_view.m_enabled) return m_impl->m_view.m_scale;
+    return m_impl->m_drawGridLayer->m_editorLayer->m_objectLayer->getScale();
+}
@@ -1,5 +1,10 @@
 #include "../include/DrawGridAPI.hpp"
 #include "../include/DrawLayers.hpp"
+#include "DrawGridAPIImpl.hpp"
+#include "LineKernels.hpp"
+#include "WorkerPool.hpp"
+#include <cstring>
+#include <chrono>
 #include <Geode/Geode.hpp>
 
 using namespace geode::prelude;
@@ -22,70 +27,64 @@ LineColor::LineColor(const cocos2d::ccColor4B& colorA, const cocos2d::ccColor4B&
     m_hasColorB = true;
 }
 
-cocos2d::ccColor4B LineColor::getColorA() const {
-    return m_colorA;
-}
-
-cocos2d::ccColor4B LineColor::getColorB() const {
-    return m_hasColorB ? m_colorB : m_colorA;
-}
-
-struct DrawGridAPIImpl {
-    float m_gridWidthMin = -3000.f;
-    float m_gridHeightMin = -3000.f;
-    float m_gridWidthMax = 240000.f;
-    float m_gridHeightMax = 30090.f;
-    bool m_vanillaDraw = false;
-    bool m_hideInvisible = false;
-    bool m_lineSmoothing = false;
-    float m_lineSmoothingLimit = 0.4f;
-    bool m_dirtyViewTransform = true;
-    bool m_shouldSort = true;
-    bool m_invertGrid = false;
-    float m_cachedOverdrawFactor = 1.f;
-    float m_minPortalY = 0;
-    float m_maxPortalY = 0;
-
-    DrawGridAPI::DrawMode m_nextDrawMode = DrawGridAPI::DrawMode::NONE;
-    CCSize m_cachedWorldViewSize;
-    CCGLProgram* m_shader = nullptr;
-    std::unordered_map<float, ccColor4B> m_timeMarkers;
-    std::map<float, std::vector<Vertex>> m_lineVertsBuffer;
-    std::map<float, std::vector<Vertex>> m_blendedLineVertsBuffer;
-    std::map<float, std::vector<Vertex>> m_invertedLineVertsBuffer;
-    std::vector<Vertex> m_rectVertsBuffer;
-    std::vector<Vertex> m_blendedRectVertsBuffer;
-    std::vector<Vertex> m_invertedRectVertsBuffer;
-    std::vector<Vertex> m_rectOutlineVertsBuffer;
-    std::vector<Vertex> m_blendedRectOutlineVertsBuffer;
-    std::vector<Vertex> m_invertedRectOutlineVertsBuffer;
-    DrawGridLayer* m_drawGridLayer = nullptr;
-    std::vector<std::unique_ptr<DrawNode>> m_drawNodes;
-};
+static thread_local VertexBuffers* t_targetBuffers = nullptr;
+
+TargetBuffersScope::TargetBuffersScope(VertexBuffers* buffers) {
+    t_targetBuffers = buffers;
+}
+
+TargetBuffersScope::~TargetBuffersScope() {
+    t_targetBuffers = nullptr;
+}
+
+VertexBuffers& DrawGridAPIImpl::targetBuffers() {
+    return t_targetBuffers ? *t_targetBuffers : m_buffers;
+}
+
+DrawGridAPIImpl::~DrawGridAPIImpl() {
+    SubmittedBatch* submitted = m_submittedBatches.exchange(nullptr);
+    while (submitted) {
+        std::unique_ptr<SubmittedBatch> owned(submitted);
+        submitted = submitted->m_next;
+    }
+}
 
 DrawGridAPI::DrawGridAPI() : m_impl(std::make_unique<DrawGridAPIImpl>()) {
-    addDraw<Grid>("grid");
-    addDraw<Bounds>("bounds");
+    m_impl->m_api = this;
+    addDraw<Grid>("grid").setThreadSafe(true);
+    addDraw<Bounds>("bounds").setThreadSafe(true);
     addDraw<Ground>("ground");
-    addDraw<GuideObjects>("guide-objects");
-    addDraw<PreviewLockLine>("preview-lock-line");
-    addDraw<EffectLines>("effect-lines");
+    addDraw<GuideObjects>("guide-objects").setThreadSafe(true);
+    addDraw<PreviewLockLine>("preview-lock-line").setThreadSafe(true);
+    addDraw<EffectLines>("effect-lines").setThreadSafe(true);
     addDraw<DurationLines>("duration-lines");
-    addDraw<Guidelines>("guidelines");
-    addDraw<BPMTriggers>("bpm-triggers");
+    addDraw<Guidelines>("guidelines").setThreadSafe(true);
+    addDraw<BPMTriggers>("bpm-triggers").setThreadSafe(true);
     addDraw<AudioLine>("audio-line");
     addDraw<PositionLines>("position-lines");
+    addDraw<LevelOverview>("level-overview");
+
+    for (const char* id : {"grid", "bounds", "effect-lines", "guidelines"}) {
+        m_impl->m_nodesByID[id]->setCacheable(true);
+    }
+    // the most expensive layers on big levels, and the ones that matter least while editing
+    for (const char* id : {"duration-lines", "bpm-triggers"}) {
+        m_impl->m_nodesByID[id]->setBudgetPriority(-1);
+    }
 }
 
 DrawGridAPI::~DrawGridAPI() = default;
 
-DrawGridAPI::DrawGridAPI(DrawGridAPI&&) noexcept = default;
-
-DrawGridAPI& DrawGridAPI::operator=(DrawGridAPI&&) noexcept = default;
+DrawGridAPI::DrawGridAPI(DrawGridAPI&& other) noexcept : m_impl(std::move(other.m_impl)) {
+    m_impl->m_api = this;
+    for (auto& drawNode : m_impl->m_drawNodes) drawNode->setAPI(this);
+}
 
-DrawGridAPI& DrawGridAPI::get() {
-    static DrawGridAPI instance;
-    return instance;
+DrawGridAPI& DrawGridAPI::operator=(DrawGridAPI&& other) noexcept {
+    m_impl = std::move(other.m_impl);
+    m_impl->m_api = this;
+    for (auto& drawNode : m_impl->m_drawNodes) drawNode->setAPI(this);
+    return *this;
 }
 
 void DrawGridAPI::init(DrawGridLayer* drawGridLayer, cocos2d::CCGLProgram* shader) {
@@ -95,20 +94,29 @@ void DrawGridAPI::init(DrawGridLayer* drawGridLayer, cocos2d::CCGLProgram* shade
     m_impl->m_cachedOverdrawFactor = 1.f;
     m_impl->m_cachedWorldViewSize = CCSize{0, 0};
     m_impl->m_shouldSort = true;
-    m_impl->m_lineVertsBuffer.clear();
-    m_impl->m_blendedLineVertsBuffer.clear();
-    m_impl->m_invertedLineVertsBuffer.clear();
-    m_impl->m_rectVertsBuffer.clear();
-    m_impl->m_blendedRectVertsBuffer.clear();
-    m_impl->m_invertedRectVertsBuffer.clear();
-    m_impl->m_rectOutlineVertsBuffer.clear();
-    m_impl->m_blendedRectOutlineVertsBuffer.clear();
-    m_impl->m_invertedRectOutlineVertsBuffer.clear();
+    // capacity is kept across editor sessions, the memory policy decides when to give it back
+    m_impl->m_buffers.reset();
+    forgetPersistentBuffers(*m_impl);
+    resetGPUTimers(*m_impl);
+    invalidateTriggerTables();
 
     if (Loader::get()->isModLoaded("raydeeux.grandeditorextension") || Mod::get()->getSettingValue<bool>("extension-override")) {
         m_impl->m_gridWidthMax = FLT_MAX;
     }
 
+    setParallelDraw(Mod::get()->getSettingValue<bool>("parallel-draw"));
+    setPipelinedDraw(Mod::get()->getSettingValue<bool>("pipelined-draw"));
+    setGPUTiming(Mod::get()->getSettingValue<bool>("gpu-timing"));
+    setMemoryBudget(Mod::get()->getSettingValue<int64_t>("memory-budget") * 1024 * 1024);
+    setGeometryOptimization(Mod::get()->getSettingValue<bool>("optimize-geometry"));
+    setStaticCache(Mod::get()->getSettingValue<bool>("static-cache"));
+    setFrameBudget(Mod::get()->getSettingValue<int64_t>("frame-budget"));
+
+    const auto aggregation = Mod::get()->getSettingValue<std::string>("column-aggregation");
+    if (aggregation == "Max Alpha") setColumnAggregation(ColumnAggregation::MAX_ALPHA);
+    else if (aggregation == "Blended Alpha") setColumnAggregation(ColumnAggregation::BLENDED_ALPHA);
+    else setColumnAggregation(ColumnAggregation::OFF);
+
     for (const auto& drawNode : m_impl->m_drawNodes) {
         if (drawNode->isEnabled()) {
             drawNode->init(m_impl->m_drawGridLayer);
@@ -124,11 +132,20 @@ void DrawGridAPI::shouldSort() {
     m_impl->m_shouldSort = true;
 }
 
+// stable so nodes sharing a z order keep the order they were added in
 void DrawGridAPI::sort() {
-    std::sort(m_impl->m_drawNodes.begin(), m_impl->m_drawNodes.end(), [](const std::unique_ptr<DrawNode>& a, const std::unique_ptr<DrawNode>& b) {
+    std::stable_sort(m_impl->m_drawNodes.begin(), m_impl->m_drawNodes.end(), [](const std::unique_ptr<DrawNode>& a, const std::unique_ptr<DrawNode>& b) {
         return a->getZOrder() < b->getZOrder();
     });
 
+    m_impl->m_nodesByType.clear();
+    // fewer entries than nodes means some share an ID, and which of them comes first may have changed
+    if (m_impl->m_nodesByID.size() != m_impl->m_drawNodes.size()) {
+        m_impl->m_nodesByID.clear();
+        for (const auto& drawNode : m_impl->m_drawNodes) {
+            m_impl->m_nodesByID.emplace(drawNode->getIDRef(), drawNode.get());
+        }
+    }
     m_impl->m_shouldSort = false;
 }
 
@@ -158,6 +175,31 @@ void DrawGridAPI::overrideGridBoundsOrigin(cocos2d::CCPoint point) {
     m_impl->m_gridHeightMin = point.y; 
 }
 
+void DrawGridAPI::setParallelDraw(bool enabled) {
+    m_impl->m_parallelDraw = enabled;
+    if (!enabled && !m_impl->m_pipelinedDraw) m_impl->m_workerPool.reset();
+}
+
+bool DrawGridAPI::isParallelDraw() {
+    return m_impl->m_parallelDraw;
+}
+
+void DrawGridAPI::setPipelinedDraw(bool enabled) {
+    if (m_impl->m_pipelinedDraw == enabled) return;
+    m_impl->m_pipelinedDraw = enabled;
+    if (!enabled && !m_impl->m_parallelDraw) m_impl->m_workerPool.reset();
+    // whatever was prepared ahead would otherwise be drawn twice
+    m_impl->m_buffers.reset();
+}
+
+bool DrawGridAPI::isPipelinedDraw() {
+    return m_impl->m_pipelinedDraw;
+}
+
+FrameTimings DrawGridAPI::getFrameTimings() {
+    return m_impl->m_frameTimings;
+}
+
 void DrawGridAPI::setInvertGrid(bool invert) {
     m_impl->m_invertGrid = invert;
 }
@@ -175,7 +217,9 @@ cocos2d::CCPoint DrawGridAPI::getGridBoundsOrigin() {
 }
 
 void DrawGridAPI::generateTimeMarkers() {
-    m_impl->m_timeMarkers.clear();
+    TraceScope trace(*m_impl, "markers", "generateTimeMarkers");
+    m_impl->m_level->m_timeMarkers.clear();
+    ++m_impl->m_level->m_timeMarkersGeneration;
     auto markers = CCArrayExt<CCString*>(m_impl->m_drawGridLayer->m_timeMarkers);
     if (markers.size() < 2) return;
 
@@ -195,12 +239,27 @@ void DrawGridAPI::generateTimeMarkers() {
         else if (type >= 0.8f || type == 0.0f) color = colorC;
         else color = colorD;
 
-        m_impl->m_timeMarkers[pos] = color;
+        m_impl->m_level->m_timeMarkers[pos] = color;
     }
 }
 
 std::unordered_map<float, cocos2d::ccColor4B> DrawGridAPI::getTimeMarkers() { 
-    return m_impl->m_timeMarkers; 
+    return m_impl->m_level->m_timeMarkers; 
+}
+
+const std::unordered_map<float, cocos2d::ccColor4B>& DrawGridAPI::getTimeMarkersRef() {
+    return m_impl->m_level->m_timeMarkers;
+}
+
+uint64_t DrawGridAPI::getTimeMarkersGeneration() {
+    return m_impl->m_level->m_timeMarkersGeneration;
+}
+
+float DrawGridAPI::getPixelsPerUnit() {
+    if (m_impl->m_frameView.m_active) return m_impl->m_frameView.m_pixelsPerUnit;
+    const CCSize winSize = CCDirector::get()->getWinSize();
+    const CCSize winSizeInPixels = CCDirector::get()->getWinSizeInPixels();
+    return getViewScale() * winSizeInPixels.width / winSize.width;
 }
 
 cocos2d::CCSize DrawGridAPI::getWorldViewSize() { 
@@ -219,6 +278,10 @@ bool DrawGridAPI::isVanillaDraw() {
     return m_impl->m_vanillaDraw; 
 }
 
+bool DrawGridAPI::isHideInvisible() {
+    return m_impl->m_hideInvisible;
+}
+
 bool DrawGridAPI::hasLineSmoothing() {
     return m_impl->m_lineSmoothing;
 }
@@ -227,12 +290,17 @@ float DrawGridAPI::getLineSmoothingLimit() {
     return m_impl->m_lineSmoothingLimit;
 }
 
+const char* DrawGridAPI::getLineKernelName() {
+    return LineKernels::getKernelName();
+}
+
 void DrawGridAPI::ensureViewTransformValid() {
     if (!m_impl->m_dirtyViewTransform && m_impl->m_drawGridLayer->m_editorLayer->m_playbackMode != PlaybackMode::Playing) return;
     
-    const CCSize winSize = CCDirector::get()->getWinSize();
-    const float scale = m_impl->m_drawGridLayer->m_editorLayer->m_objectLayer->getScale();
-    const float rotationRad = CC_DEGREES_TO_RADIANS(m_impl->m_drawGridLayer->m_editorLayer->m_gameState.m_cameraAngle);
+    const ViewCamera camera = currentCamera(*m_impl);
+    const CCSize winSize = camera.m_size;
+    const float scale = camera.m_scale;
+    const float rotationRad = CC_DEGREES_TO_RADIANS(camera.m_angle);
     const float sinRot = std::sin(rotationRad);
     const float cosRot = std::cos(rotationRad);
     
@@ -272,6 +340,65 @@ void reserveIfNeeded(std::vector<T>& vec, size_t minCapacity) {
     if (vec.capacity() < minCapacity) vec.reserve(minCapacity);
 }
 
+constexpr size_t kReserveLines = 4096;
+constexpr size_t kReserveRects = 2048;
+
+static const char* getDrawModeName(DrawGridAPI::DrawMode drawMode) {
+    switch (drawMode) {
+        case DrawGridAPI::DrawMode::BLEND: return "blend";
+        case DrawGridAPI::DrawMode::INVERT: return "invert";
+        default: return "normal";
+    }
+}
+
+static const char* getPrimitiveKindName(PrimitiveKind kind) {
+    switch (kind) {
+        case PrimitiveKind::RECT: return "rects";
+        case PrimitiveKind::RECT_OUTLINE: return "outlines";
+        default: return "lines";
+    }
+}
+
+static void drawBucket(DrawGridAPIImpl& impl, std::vector<Vertex>& vertices, size_t reserve, DrawGridAPI::DrawMode drawMode, PrimitiveKind kind, float width) {
+    if (vertices.empty()) return;
+    reserveIfNeeded(vertices, reserve);
+
+    glVertexAttribPointer(kCCVertexAttrib_Position, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), &vertices[0].position);
+    glVertexAttribPointer(kCCVertexAttrib_Color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), &vertices[0].color);
+    const auto start = impl.m_trace.m_enabled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+    if (impl.m_gpuTimers.m_active) beginGPUTimer(impl);
+    glDrawArrays(kind == PrimitiveKind::LINE ? GL_LINES : GL_TRIANGLES, 0, vertices.size());
+    if (impl.m_gpuTimers.m_active) endGPUTimer(impl);
+
+    if (impl.m_trace.m_enabled) {
+        recordTraceEvent(impl, "bucket", fmt::format("{} {} {}", getDrawModeName(drawMode), getPrimitiveKindName(kind), width), start, std::chrono::steady_clock::now(), fmt::format("\"vertices\":{}", vertices.size()));
+    }
+
+    if (impl.m_profiler.m_enabled) recordDrawCall(impl, drawMode, kind, width, vertices.size());
+}
+
+static void drawBuckets(DrawGridAPIImpl& impl, VertexBuffers& buffers, DrawGridAPI::DrawMode drawMode, float widthModifier, bool persistent) {
+    for (auto& [width, vertices] : buffers.lineBuckets(drawMode)) {
+        if (!vertices.empty()) glLineWidth(width + widthModifier);
+        drawBucket(impl, vertices, kReserveLines, drawMode, PrimitiveKind::LINE, width);
+    }
+    drawBucket(impl, buffers.rects(drawMode), kReserveRects, drawMode, PrimitiveKind::RECT, 0);
+    drawBucket(impl, buffers.rectOutlines(drawMode), kReserveRects, drawMode, PrimitiveKind::RECT_OUTLINE, 0);
+
+    if (persistent) drawPersistentPrimitives(impl, drawMode, widthModifier);
+}
+
+void submitBuffers(DrawGridAPIImpl& impl, VertexBuffers& buffers, float widthModifier, bool persistent) {
+    ccGLBlendFunc(GL_ONE_MINUS_DST_COLOR, GL_ONE_MINUS_SRC_ALPHA);
+    drawBuckets(impl, buffers, DrawGridAPI::DrawMode::INVERT, widthModifier, persistent);
+
+    ccGLBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    drawBuckets(impl, buffers, DrawGridAPI::DrawMode::NORMAL, widthModifier, persistent);
+
+    ccGLBlendFunc(GL_ONE, GL_ONE);
+    drawBuckets(impl, buffers, DrawGridAPI::DrawMode::BLEND, widthModifier, persistent);
+}
+
 /*
     here's where the performance happens, it's all because I cheat! The editor doesn't have many different
     width lines, so I draw them separately in their own batches reducing the amount of gl draw calls.
@@ -281,12 +408,10 @@ void reserveIfNeeded(std::vector<T>& vec, size_t minCapacity) {
     to create your own layer to draw on as this layer is now specially made with performance in mind.
 */ 
 void DrawGridAPI::batchDraw() {
-    bool shouldSmooth = m_impl->m_drawGridLayer->m_editorLayer->m_objectLayer->getScale() >= m_impl->m_lineSmoothingLimit && m_impl->m_lineSmoothing;
+    TraceScope trace(*m_impl, "batch", "batchDraw");
+    bool shouldSmooth = getViewScale() >= m_impl->m_lineSmoothingLimit && m_impl->m_lineSmoothing;
     float widthModifier = 0;
 
-    constexpr size_t kReserveLines = 4096;
-    constexpr size_t kReserveRects = 2048;
-
     #ifdef GEODE_IS_DESKTOP
     if (shouldSmooth) {
         glEnable(GL_LINE_SMOOTH);
@@ -295,92 +420,14 @@ void DrawGridAPI::batchDraw() {
     }
     #endif 
     
-    ccGLBlendFunc(GL_ONE_MINUS_DST_COLOR, GL_ONE_MINUS_SRC_ALPHA);
-
-    if (!m_impl->m_invertedLineVertsBuffer.empty()){
-        for (auto& [k, v] : m_impl->m_invertedLineVertsBuffer) {
-            reserveIfNeeded(v, kReserveLines);
-            if (!v.empty()) {
-                glVertexAttribPointer(kCCVertexAttrib_Position, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), &v[0].position);
-                glVertexAttribPointer(kCCVertexAttrib_Color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), &v[0].color);
-                float width = k + widthModifier;
-                glLineWidth(width);
-                glDrawArrays(GL_LINES, 0, v.size());
-            }
-        }
-    }
-
-    if (!m_impl->m_invertedRectVertsBuffer.empty()){
-        reserveIfNeeded(m_impl->m_invertedRectVertsBuffer, kReserveRects);
-        glVertexAttribPointer(kCCVertexAttrib_Position, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), &m_impl->m_blendedRectVertsBuffer[0].position);
-        glVertexAttribPointer(kCCVertexAttrib_Color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), &m_impl->m_blendedRectVertsBuffer[0].color);
-        glDrawArrays(GL_TRIANGLES, 0, m_impl->m_invertedRectVertsBuffer.size());
-    }
-    
-    if (!m_impl->m_invertedRectOutlineVertsBuffer.empty()){
-        reserveIfNeeded(m_impl->m_invertedRectOutlineVertsBuffer, kReserveRects);
-        glVertexAttribPointer(kCCVertexAttrib_Position, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), &m_impl->m_blendedRectOutlineVertsBuffer[0].position);
-        glVertexAttribPointer(kCCVertexAttrib_Color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), &m_impl->m_blendedRectOutlineVertsBuffer[0].color);
-        glDrawArrays(GL_TRIANGLES, 0, m_impl->m_invertedRectOutlineVertsBuffer.size());
-    }
-
-    ccGLBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-    
-    if (!m_impl->m_lineVertsBuffer.empty()){
-        for (auto& [k, v] : m_impl->m_lineVertsBuffer) {
-            reserveIfNeeded(v, kReserveLines);
-            if (!v.empty()) {
-                glVertexAttribPointer(kCCVertexAttrib_Position, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), &v[0].position);
-                glVertexAttribPointer(kCCVertexAttrib_Color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), &v[0].color);
-                float width = k + widthModifier;
-                glLineWidth(width);
-                glDrawArrays(GL_LINES, 0, v.size());
-            }
-        }
-    }
-
-    if (!m_impl->m_rectVertsBuffer.empty()){
-        reserveIfNeeded(m_impl->m_rectVertsBuffer, kReserveRects);
-        glVertexAttribPointer(kCCVertexAttrib_Position, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), &m_impl->m_rectVertsBuffer[0].position);
-        glVertexAttribPointer(kCCVertexAttrib_Color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), &m_impl->m_rectVertsBuffer[0].color);
-        glDrawArrays(GL_TRIANGLES, 0, m_impl->m_rectVertsBuffer.size());
-    }
-    
-    if (!m_impl->m_rectOutlineVertsBuffer.empty()){
-        reserveIfNeeded(m_impl->m_rectOutlineVertsBuffer, kReserveRects);
-        glVertexAttribPointer(kCCVertexAttrib_Position, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), &m_impl->m_rectOutlineVertsBuffer[0].position);
-        glVertexAttribPointer(kCCVertexAttrib_Color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), &m_impl->m_rectOutlineVertsBuffer[0].color);
-        glDrawArrays(GL_TRIANGLES, 0, m_impl->m_rectOutlineVertsBuffer.size());
-    }
-
-    ccGLBlendFunc(GL_ONE, GL_ONE);
-
-    if (!m_impl->m_blendedLineVertsBuffer.empty()){
-        for (auto& [k, v] : m_impl->m_blendedLineVertsBuffer) {
-            reserveIfNeeded(v, kReserveLines);
-            if (!v.empty()) {
-                glVertexAttribPointer(kCCVertexAttrib_Position, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), &v[0].position);
-                glVertexAttribPointer(kCCVertexAttrib_Color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), &v[0].color);
-                float width = k + widthModifier;
-                glLineWidth(width);
-                glDrawArrays(GL_LINES, 0, v.size());
-            }
-        }
-    }
-
-    if (!m_impl->m_blendedRectVertsBuffer.empty()){
-        reserveIfNeeded(m_impl->m_blendedRectVertsBuffer, kReserveRects);
-        glVertexAttribPointer(kCCVertexAttrib_Position, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), &m_impl->m_blendedRectVertsBuffer[0].position);
-        glVertexAttribPointer(kCCVertexAttrib_Color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), &m_impl->m_blendedRectVertsBuffer[0].color);
-        glDrawArrays(GL_TRIANGLES, 0, m_impl->m_blendedRectVertsBuffer.size());
-    }
-    
-    if (!m_impl->m_blendedRectOutlineVertsBuffer.empty()){
-        reserveIfNeeded(m_impl->m_blendedRectOutlineVertsBuffer, kReserveRects);
-        glVertexAttribPointer(kCCVertexAttrib_Position, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), &m_impl->m_blendedRectOutlineVertsBuffer[0].position);
-        glVertexAttribPointer(kCCVertexAttrib_Color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), &m_impl->m_blendedRectOutlineVertsBuffer[0].color);
-        glDrawArrays(GL_TRIANGLES, 0, m_impl->m_blendedRectOutlineVertsBuffer.size());
+    // smoothed lines blend into each other at their edges, so dropping or merging them changes how they look
+    if (m_impl->m_optimizeGeometry && !shouldSmooth) {
+        TraceScope trace(*m_impl, "batch", "optimizeGeometry");
+        optimizeGeometry(*m_impl);
     }
+    else m_impl->m_geometryStats = {};
+    if (m_impl->m_capture.m_remaining > 0) captureFrame(*m_impl);
+    submitBuffers(*m_impl, m_impl->m_buffers, widthModifier, true);
 
     #ifdef GEODE_IS_DESKTOP
     if (shouldSmooth) {
@@ -388,167 +435,170 @@ void DrawGridAPI::batchDraw() {
     }
     #endif
 
-    for (auto& [_, v] : m_impl->m_lineVertsBuffer) v.resize(0);
-    for (auto& [_, v] : m_impl->m_blendedLineVertsBuffer) v.resize(0);
-    for (auto& [_, v] : m_impl->m_invertedLineVertsBuffer) v.resize(0);
-    m_impl->m_rectVertsBuffer.resize(0);
-    m_impl->m_blendedRectVertsBuffer.resize(0);
-    m_impl->m_invertedRectVertsBuffer.resize(0);
-    m_impl->m_rectOutlineVertsBuffer.resize(0);
-    m_impl->m_blendedRectOutlineVertsBuffer.resize(0);
-    m_impl->m_invertedRectOutlineVertsBuffer.resize(0);
+    applyMemoryPolicy(*m_impl);
+    m_impl->m_buffers.reset();
 
     glLineWidth(1);
+
+    if (!m_impl->m_customDraws.empty()) {
+        TraceScope trace(*m_impl, "batch", "customDraws");
+        for (auto& customDraw : m_impl->m_customDraws) customDraw();
+        m_impl->m_customDraws.clear();
+    }
 }
 
 void DrawGridAPI::setNextDrawMode(DrawMode drawMode) {
     
 }
 
+// lines are only clipped while the camera is turned, otherwise the bounds nodes draw in are already tight
+static void pushLine(const ViewPolygon& view, std::vector<Vertex>& buffer, ccVertex2F start, ccVertex2F end, const LineColor& color, float width) {
+    ccColor4B colorA = color.getColorA();
+    ccColor4B colorB = color.getColorB();
+    if (view.rotated && !view.clipLine(start, end, colorA, colorB, width)) return;
+    buffer.push_back({start, colorA});
+    buffer.push_back({end, colorB});
+}
+
 void DrawGridAPI::drawLine(const cocos2d::ccVertex2F& a, const cocos2d::ccVertex2F& b, const LineColor& color, float width, bool blend) {
-    if (m_impl->m_nextDrawMode != DrawMode::NONE) {
-        drawLineV2(a, b, color, width, m_impl->m_nextDrawMode);
-        m_impl->m_nextDrawMode = DrawMode::NONE;
+    auto& buffers = m_impl->targetBuffers();
+    if (buffers.m_nextDrawMode != DrawMode::NONE) {
+        drawLineV2(a, b, color, width, buffers.m_nextDrawMode);
+        buffers.m_nextDrawMode = DrawMode::NONE;
         return;
     }
     if (blend) {
-        m_impl->m_blendedLineVertsBuffer[width].push_back({a, color.getColorA()});
-        m_impl->m_blendedLineVertsBuffer[width].push_back({b, color.getColorB()});
+        pushLine(m_impl->m_viewPolygon, buffers.m_blendedLineVertsBuffer[width], a, b, color, width);
     } else {
-        m_impl->m_lineVertsBuffer[width].push_back({a, color.getColorA()});
-        m_impl->m_lineVertsBuffer[width].push_back({b, color.getColorB()});
+        pushLine(m_impl->m_viewPolygon, buffers.m_lineVertsBuffer[width], a, b, color, width);
     }
 }
 
 void DrawGridAPI::drawLineV2(const cocos2d::ccVertex2F& start, const cocos2d::ccVertex2F& end, const LineColor& color, float width, DrawMode drawMode) {
-    if (m_impl->m_nextDrawMode != DrawMode::NONE) {
-        drawMode = m_impl->m_nextDrawMode;
-        m_impl->m_nextDrawMode = DrawMode::NONE;
+    auto& buffers = m_impl->targetBuffers();
+    if (buffers.m_nextDrawMode != DrawMode::NONE) {
+        drawMode = buffers.m_nextDrawMode;
+        buffers.m_nextDrawMode = DrawMode::NONE;
     }
     switch (drawMode) {
         case DrawMode::NORMAL: {
-            m_impl->m_lineVertsBuffer[width].push_back({start, color.getColorA()});
-            m_impl->m_lineVertsBuffer[width].push_back({end, color.getColorB()});
+            pushLine(m_impl->m_viewPolygon, buffers.m_lineVertsBuffer[width], start, end, color, width);
             break;
         }
         case DrawMode::BLEND: {
-            m_impl->m_blendedLineVertsBuffer[width].push_back({start, color.getColorA()});
-            m_impl->m_blendedLineVertsBuffer[width].push_back({end, color.getColorB()});
+            pushLine(m_impl->m_viewPolygon, buffers.m_blendedLineVertsBuffer[width], start, end, color, width);
             break;
         }
         case DrawMode::INVERT: {
-            m_impl->m_invertedLineVertsBuffer[width].push_back({start, color.getColorA()});
-            m_impl->m_invertedLineVertsBuffer[width].push_back({end, color.getColorB()});
+            pushLine(m_impl->m_viewPolygon, buffers.m_invertedLineVertsBuffer[width], start, end, color, width);
             break;
         }
         default: break;
     }
 }
 
-std::array<Vertex, 6> DrawGridAPI::rectToTriangles(const CCRect& rect, const ccColor4B& color) {
-    float x = rect.getMinX();
-    float y = rect.getMinY();
-    float w = rect.size.width;
-    float h = rect.size.height;
-
-    return {
-        Vertex{x,     y, color},
-        Vertex{x + w, y, color},
-        Vertex{x + w, y + h, color},
-
-        Vertex{x,     y, color},
-        Vertex{x + w, y + h, color},
-        Vertex{x,     y + h, color}
-    };
-}
-
-std::array<Vertex, 24> DrawGridAPI::rectToBorderTriangles(const CCRect& rect, const ccColor4B& color, float width) {
-    float x = rect.getMinX();
-    float y = rect.getMinY();
-    float w = rect.size.width;
-    float h = rect.size.height;
-
-    float t = width;
-
-    float ox0 = x - t;
-    float oy0 = y - t;
-    float ox1 = x + w + t;
-    float oy1 = y + h + t;
-
-    float ix0 = x;
-    float iy0 = y;
-    float ix1 = x + w;
-    float iy1 = y + h;
-
-    return {
-        Vertex{ox0, oy0, color},
-        Vertex{ox1, oy0, color},
-        Vertex{ix1, iy0, color},
-        Vertex{ox0, oy0, color},
-        Vertex{ix1, iy0, color},
-        Vertex{ix0, iy0, color},
-
-        Vertex{ox1, oy0, color},
-        Vertex{ox1, oy1, color},
-        Vertex{ix1, iy1, color},
-        Vertex{ox1, oy0, color},
-        Vertex{ix1, iy1, color},
-        Vertex{ix1, iy0, color},
-
-        Vertex{ox1, oy1, color},
-        Vertex{ox0, oy1, color},
-        Vertex{ix0, iy1, color},
-        Vertex{ox1, oy1, color},
-        Vertex{ix0, iy1, color},
-        Vertex{ix1, iy1, color},
-
-        Vertex{ox0, oy1, color},
-        Vertex{ox0, oy0, color},
-        Vertex{ix0, iy0, color},
-        Vertex{ox0, oy1, color},
-        Vertex{ix0, iy0, color},
-        Vertex{ix0, iy1, color}
-    };
+static uint32_t packColor(const ccColor4B& color) {
+    uint32_t packed;
+    std::memcpy(&packed, &color, sizeof(packed));
+    return packed;
+}
+
+std::vector<Vertex>& DrawGridAPI::acquireLineBuffer(float width, DrawMode drawMode) {
+    return m_impl->targetBuffers().lines(drawMode, width);
+}
+
+std::vector<Vertex>& DrawGridAPI::acquireRectBuffer(DrawMode drawMode) {
+    return m_impl->targetBuffers().rects(drawMode);
+}
+
+std::vector<Vertex>& DrawGridAPI::acquireRectOutlineBuffer(DrawMode drawMode) {
+    return m_impl->targetBuffers().rectOutlines(drawMode);
+}
+
+// runs skip the per line push_back and let the line kernels write the whole batch in one go
+static void drawLineRun(VertexBuffers& buffers, const ViewPolygon& view, bool vertical, float origin, float spacing, int first, int last, float from, float to, const LineColor& color, float width, DrawGridAPI::DrawMode drawMode, int accentEvery, const LineColor& accentColor) {
+    if (buffers.m_nextDrawMode != DrawGridAPI::DrawMode::NONE) {
+        drawMode = buffers.m_nextDrawMode;
+        buffers.m_nextDrawMode = DrawGridAPI::DrawMode::NONE;
+    }
+    if (last < first || drawMode == DrawGridAPI::DrawMode::NONE) return;
+
+    auto& buffer = buffers.lines(drawMode, width);
+    const size_t count = static_cast<size_t>(last - first) + 1;
+    const size_t offset = buffer.size();
+    buffer.resize(offset + count * 2);
+
+    LineKernels::emit(buffer.data() + offset, {
+        origin, spacing, first, count, from, to,
+        packColor(color.getColorA()), packColor(color.getColorB()), vertical
+    });
+
+    if (accentEvery > 0) {
+        int remainder = first % accentEvery;
+        if (remainder < 0) remainder += accentEvery;
+        const int firstAccent = remainder == 0 ? first : first + (accentEvery - remainder);
+        const ccColor4B accentA = accentColor.getColorA();
+        const ccColor4B accentB = accentColor.getColorB();
+
+        for (int64_t i = firstAccent; i <= last; i += accentEvery) {
+            Vertex* line = &buffer[offset + static_cast<size_t>(i - first) * 2];
+            line[0].color = accentA;
+            line[1].color = accentB;
+        }
+    }
+
+    // the kernels write every line across the whole run, with the view turned most of that is off screen
+    if (view.rotated) clipLineRun(view, buffer, offset, width);
+}
+
+void DrawGridAPI::drawVerticalLines(float originX, float spacing, int first, int last, float minY, float maxY, const LineColor& color, float width, DrawMode drawMode, int accentEvery, const LineColor& accentColor) {
+    drawLineRun(m_impl->targetBuffers(), m_impl->m_viewPolygon, true, originX, spacing, first, last, minY, maxY, color, width, drawMode, accentEvery, accentColor);
+}
+
+void DrawGridAPI::drawHorizontalLines(float originY, float spacing, int first, int last, float minX, float maxX, const LineColor& color, float width, DrawMode drawMode, int accentEvery, const LineColor& accentColor) {
+    drawLineRun(m_impl->targetBuffers(), m_impl->m_viewPolygon, false, originY, spacing, first, last, minX, maxX, color, width, drawMode, accentEvery, accentColor);
 }
 
 void DrawGridAPI::drawRect(const CCRect& rect, const ccColor4B& color, bool blend) {
-    if (m_impl->m_nextDrawMode != DrawMode::NONE) {
-        drawRectV2(rect, color, m_impl->m_nextDrawMode);
-        m_impl->m_nextDrawMode = DrawMode::NONE;
+    auto& buffers = m_impl->targetBuffers();
+    if (buffers.m_nextDrawMode != DrawMode::NONE) {
+        drawRectV2(rect, color, buffers.m_nextDrawMode);
+        buffers.m_nextDrawMode = DrawMode::NONE;
         return;
     }
     if (blend) {
         for (const auto& v : rectToTriangles(rect, color)) {
-            m_impl->m_blendedRectVertsBuffer.push_back(v);
+            buffers.m_blendedRectVertsBuffer.push_back(v);
         }
     } else {
         for (const auto& v : rectToTriangles(rect, color)) {
-            m_impl->m_rectVertsBuffer.push_back(v);
+            buffers.m_rectVertsBuffer.push_back(v);
         }
     }
 }
 
 void DrawGridAPI::drawRectV2(const cocos2d::CCRect& rect, const cocos2d::ccColor4B& color, DrawMode drawMode) {
-    if (m_impl->m_nextDrawMode != DrawMode::NONE) {
-        drawMode = m_impl->m_nextDrawMode;
-        m_impl->m_nextDrawMode = DrawMode::NONE;
+    auto& buffers = m_impl->targetBuffers();
+    if (buffers.m_nextDrawMode != DrawMode::NONE) {
+        drawMode = buffers.m_nextDrawMode;
+        buffers.m_nextDrawMode = DrawMode::NONE;
     }
     switch (drawMode) {
         case DrawMode::NORMAL: {
             for (const auto& v : rectToTriangles(rect, color)) {
-                m_impl->m_rectVertsBuffer.push_back(v);
+                buffers.m_rectVertsBuffer.push_back(v);
             }
             break;
         }
         case DrawMode::BLEND: {
             for (const auto& v : rectToTriangles(rect, color)) {
-                m_impl->m_blendedRectVertsBuffer.push_back(v);
+                buffers.m_blendedRectVertsBuffer.push_back(v);
             }
             break;
         }
         case DrawMode::INVERT: {
             for (const auto& v : rectToTriangles(rect, color)) {
-                m_impl->m_invertedRectVertsBuffer.push_back(v);
+                buffers.m_invertedRectVertsBuffer.push_back(v);
             }
             break;
         }
@@ -557,43 +607,45 @@ void DrawGridAPI::drawRectV2(const cocos2d::CCRect& rect, const cocos2d::ccColor
 }
 
 void DrawGridAPI::drawRectOutline(const CCRect& rect, const ccColor4B& color, float width, bool blend) {
-    if (m_impl->m_nextDrawMode != DrawMode::NONE) {
-        drawRectOutlineV2(rect, color, width, m_impl->m_nextDrawMode);
-        m_impl->m_nextDrawMode = DrawMode::NONE;
+    auto& buffers = m_impl->targetBuffers();
+    if (buffers.m_nextDrawMode != DrawMode::NONE) {
+        drawRectOutlineV2(rect, color, width, buffers.m_nextDrawMode);
+        buffers.m_nextDrawMode = DrawMode::NONE;
         return;
     }
     if (blend) {
         for (const auto& v : rectToBorderTriangles(rect, color, width)) {
-            m_impl->m_blendedRectOutlineVertsBuffer.push_back(v);
+            buffers.m_blendedRectOutlineVertsBuffer.push_back(v);
         }
     } else {
         for (const auto& v : rectToBorderTriangles(rect, color, width)) {
-            m_impl->m_rectOutlineVertsBuffer.push_back(v);
+            buffers.m_rectOutlineVertsBuffer.push_back(v);
         }
     }
 }
 
 void DrawGridAPI::drawRectOutlineV2(const cocos2d::CCRect& rect, const cocos2d::ccColor4B& color, float width, DrawMode drawMode) {
-    if (m_impl->m_nextDrawMode != DrawMode::NONE) {
-        drawMode = m_impl->m_nextDrawMode;
-        m_impl->m_nextDrawMode = DrawMode::NONE;
+    auto& buffers = m_impl->targetBuffers();
+    if (buffers.m_nextDrawMode != DrawMode::NONE) {
+        drawMode = buffers.m_nextDrawMode;
+        buffers.m_nextDrawMode = DrawMode::NONE;
     }
     switch (drawMode) {
         case DrawMode::NORMAL: {
             for (const auto& v : rectToBorderTriangles(rect, color, width)) {
-                m_impl->m_rectOutlineVertsBuffer.push_back(v);
+                buffers.m_rectOutlineVertsBuffer.push_back(v);
             }
             break;
         }
         case DrawMode::BLEND: {
             for (const auto& v : rectToBorderTriangles(rect, color, width)) {
-                m_impl->m_blendedRectOutlineVertsBuffer.push_back(v);
+                buffers.m_blendedRectOutlineVertsBuffer.push_back(v);
             }
             break;
         }
         case DrawMode::INVERT: {
             for (const auto& v : rectToBorderTriangles(rect, color, width)) {
-                m_impl->m_invertedRectOutlineVertsBuffer.push_back(v);
+                buffers.m_invertedRectOutlineVertsBuffer.push_back(v);
             }
             break;
         }
@@ -606,9 +658,50 @@ bool DrawGridAPI::isObjectVisible(GameObject* object) {
     return !isHidden || object->m_isSelected;
 }
 
+// the first node in draw order with the ID holds it, same as when lookups scanned the nodes
+static void indexNodeID(DrawGridAPIImpl& impl, const std::string& id) {
+    impl.m_nodesByID.erase(id);
+    for (const auto& drawNode : impl.m_drawNodes) {
+        if (drawNode->getIDRef() == id) {
+            impl.m_nodesByID.emplace(id, drawNode.get());
+            return;
+        }
+    }
+}
+
 void DrawGridAPI::addDrawInternal(const std::string& id, std::unique_ptr<DrawNode> drawNode) { 
     drawNode->setID(id);
+    drawNode->setAPI(this);
+    // new nodes go last, so one with an ID that's taken doesn't hold it
+    m_impl->m_nodesByID.emplace(id, drawNode.get());
     m_impl->m_drawNodes.push_back(std::move(drawNode)); 
+    m_impl->m_nodesByType.clear();
+    m_impl->m_shouldSort = true;
+}
+
+/*
+    Nodes that share an ID aren't all in the map, so renaming one looks for who holds each ID again
+    whenever the node might have been or might become the holder.
+*/
+void DrawGridAPI::renameNode(DrawNode* drawNode, const std::string& oldID) {
+    auto it = m_impl->m_nodesByID.find(oldID);
+    if (it != m_impl->m_nodesByID.end() && it->second == drawNode) indexNodeID(*m_impl, oldID);
+
+    const std::string& id = drawNode->getIDRef();
+    if (!m_impl->m_nodesByID.emplace(id, drawNode).second) indexNodeID(*m_impl, id);
+}
+
+DrawNode* DrawGridAPI::getNodeByType(std::type_index type, bool (*matches)(DrawNode*)) {
+    auto [it, inserted] = m_impl->m_nodesByType.try_emplace(type, nullptr);
+    if (!inserted) return it->second;
+
+    for (const auto& drawNode : m_impl->m_drawNodes) {
+        if (matches(drawNode.get())) {
+            it->second = drawNode.get();
+            break;
+        }
+    }
+    return it->second;
 }
 
 const std::vector<std::unique_ptr<DrawNode>>& DrawGridAPI::getDrawNodes() {
@@ -616,40 +709,213 @@ const std::vector<std::unique_ptr<DrawNode>>& DrawGridAPI::getDrawNodes() {
 }
 
 Result<DrawNode&> DrawGridAPI::getNodeByID(const std::string& id) {
-    for (const auto& drawNode : m_impl->m_drawNodes) {
-        if (drawNode->getID() == id) return geode::Ok(*drawNode);
+    auto it = m_impl->m_nodesByID.find(id);
+    if (it == m_impl->m_nodesByID.end()) return geode::Err("Node not found with ID");
+    return geode::Ok(*it->second);
+}
+
+static void pushSubmittedBatch(DrawGridAPIImpl& impl, std::unique_ptr<SubmittedBatch> submitted) {
+    SubmittedBatch* node = submitted.release();
+    node->m_next = impl.m_submittedBatches.load(std::memory_order_relaxed);
+    while (!impl.m_submittedBatches.compare_exchange_weak(node->m_next, node, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void DrawGridAPI::addCustomDraw(std::function<void()> draw) {
+    m_impl->m_customDraws.push_back(std::move(draw));
+}
+
+void DrawGridAPI::submitBatch(const std::string& channel, uint64_t generation, DrawBatch batch) {
+    auto submitted = std::make_unique<SubmittedBatch>();
+    submitted->m_channel = channel;
+    submitted->m_generation = generation;
+    submitted->m_batch = std::move(batch);
+    pushSubmittedBatch(*m_impl, std::move(submitted));
+}
+
+void DrawGridAPI::clearBatch(const std::string& channel) {
+    auto submitted = std::make_unique<SubmittedBatch>();
+    submitted->m_channel = channel;
+    submitted->m_clear = true;
+    pushSubmittedBatch(*m_impl, std::move(submitted));
+}
+
+uint64_t DrawGridAPI::getFrameNumber() {
+    return m_impl->m_frameNumber.load(std::memory_order_relaxed);
+}
+
+/*
+    Takes the whole submission stack in one exchange, so producers never wait on the render thread and
+    the render thread never waits on them. Newer generations replace a channel's batch, equal ones add
+    to it and older ones arrived too late and are dropped.
+*/
+static void drainSubmittedBatches(DrawGridAPIImpl& impl) {
+    SubmittedBatch* submitted = impl.m_submittedBatches.exchange(nullptr, std::memory_order_acquire);
+    if (!submitted) return;
+
+    SubmittedBatch* ordered = nullptr;
+    while (submitted) {
+        SubmittedBatch* next = submitted->m_next;
+        submitted->m_next = ordered;
+        ordered = submitted;
+        submitted = next;
+    }
+
+    while (ordered) {
+        std::unique_ptr<SubmittedBatch> owned(ordered);
+        ordered = ordered->m_next;
+
+        if (owned->m_clear) {
+            impl.m_channelBatches.erase(owned->m_channel);
+            continue;
+        }
+
+        auto [it, inserted] = impl.m_channelBatches.try_emplace(owned->m_channel);
+        auto& channelBatch = it->second;
+
+        if (inserted || owned->m_generation > channelBatch.m_generation) {
+            channelBatch.m_generation = owned->m_generation;
+            channelBatch.m_batch = std::move(owned->m_batch);
+        }
+        else if (owned->m_generation == channelBatch.m_generation) {
+            auto& lines = channelBatch.m_batch.lines;
+            auto& rects = channelBatch.m_batch.rects;
+            lines.insert(lines.end(), owned->m_batch.lines.begin(), owned->m_batch.lines.end());
+            rects.insert(rects.end(), owned->m_batch.rects.begin(), owned->m_batch.rects.end());
+        }
     }
-    return geode::Err("Node not found with ID");
+}
+
+static void drawSubmittedBatches(DrawGridAPI& api, DrawGridAPIImpl& impl) {
+    drainSubmittedBatches(impl);
+
+    for (const auto& [_, channelBatch] : impl.m_channelBatches) {
+        for (const auto& line : channelBatch.m_batch.lines) {
+            api.drawLineV2(line.start, line.end, line.color, line.width, line.drawMode);
+        }
+        for (const auto& rect : channelBatch.m_batch.rects) {
+            if (rect.outlineWidth > 0) api.drawRectOutlineV2(rect.rect, rect.color, rect.outlineWidth, rect.drawMode);
+            else api.drawRectV2(rect.rect, rect.color, rect.drawMode);
+        }
+    }
+}
+
+/*
+    Thread safe nodes go to the worker pool while the rest draw on the render thread. Every node batches
+    into its own slot and the slots get merged in z order afterwards, so the result is exactly what
+    drawing them one after another would give.
+*/
+static void launchWorkerNodes(DrawGridAPIImpl& impl, float minX, float maxX, float minY, float maxY) {
+    if (!impl.m_workerPool) impl.m_workerPool = std::make_unique<WorkerPool>(WorkerPool::defaultThreadCount());
+
+    const auto& drawNodes = impl.m_drawNodes;
+    if (impl.m_nodeBuffers.size() < drawNodes.size()) impl.m_nodeBuffers.resize(drawNodes.size());
+
+    for (size_t i = 0; i < drawNodes.size(); ++i) {
+        DrawNode* drawNode = drawNodes[i].get();
+        if (!drawNode->isEnabled() || !drawNode->isThreadSafe() || drawnFromStaticCache(impl, *drawNode)) continue;
+
+        VertexBuffers* slot = &impl.m_nodeBuffers[i];
+        if (reuseDegradedGeometry(impl, *drawNode, *slot)) continue;
+        DrawGridAPIImpl* owner = &impl;
+        impl.m_workerPool->submit([=] {
+            CurrentContextScope context(owner->m_api);
+            TargetBuffersScope scope(slot);
+            try {
+                drawNodeProfiled(*owner, i, *slot, minX, maxX, minY, maxY);
+            } catch (...) {
+                // half of a node's geometry would get merged as if it were all of it
+                slot->reset();
+                throw;
+            }
+        });
+    }
+}
+
+static void drawRenderThreadNodes(DrawGridAPIImpl& impl, float minX, float maxX, float minY, float maxY) {
+    const auto& drawNodes = impl.m_drawNodes;
+
+    for (size_t i = 0; i < drawNodes.size(); ++i) {
+        DrawNode* drawNode = drawNodes[i].get();
+        if (!drawNode->isEnabled() || drawNode->isThreadSafe() || drawnFromStaticCache(impl, *drawNode)) continue;
+        if (reuseDegradedGeometry(impl, *drawNode, impl.m_nodeBuffers[i])) continue;
+
+        TargetBuffersScope scope(&impl.m_nodeBuffers[i]);
+        drawNodeProfiled(impl, i, impl.m_nodeBuffers[i], minX, maxX, minY, maxY);
+    }
+}
+
+static void mergeNodeBuffers(DrawGridAPIImpl& impl) {
+    impl.m_workerPool->wait();
+
+    for (size_t i = 0; i < impl.m_drawNodes.size(); ++i) {
+        impl.m_buffers.append(impl.m_nodeBuffers[i]);
+        impl.m_nodeBuffers[i].reset();
+    }
+}
+
+static void recordFrameTimings(DrawGridAPIImpl& impl, std::chrono::duration<float, std::milli> generate, std::chrono::duration<float, std::milli> submit, std::chrono::duration<float, std::milli> total) {
+    auto& timings = impl.m_frameTimings;
+    timings.generateMs = generate.count();
+    timings.submitMs = submit.count();
+    timings.totalMs = total.count();
+    timings.pipelined = impl.m_pipelinedDraw;
+
+    constexpr float smoothing = 0.05f;
+    timings.averageGenerateMs += (timings.generateMs - timings.averageGenerateMs) * smoothing;
+    timings.averageSubmitMs += (timings.submitMs - timings.averageSubmitMs) * smoothing;
+    timings.averageTotalMs += (timings.totalMs - timings.averageTotalMs) * smoothing;
 }
 
 void DrawGridAPI::draw() {
     if (m_impl->m_vanillaDraw) return m_impl->m_drawGridLayer->draw();
-    if (m_impl->m_drawGridLayer->m_editorLayer->m_objectLayer->getScale() == 0) return;
+    if (getViewScale() == 0) return;
+
+    // nodes reach the API through DrawGridAPI::get(), which has to be this context while it draws
+    CurrentContextScope context(this);
+
+    const auto frameStart = std::chrono::steady_clock::now();
 
     GLint oldSrc, oldDst;
     glGetIntegerv(GL_BLEND_SRC_ALPHA, &oldSrc);
     glGetIntegerv(GL_BLEND_DST_ALPHA, &oldDst);
 
-    ensureViewTransformValid();
-    sort();
+    {
+        TraceScope trace(*m_impl, "view", "ensureViewTransformValid");
+        ensureViewTransformValid();
+    }
+    if (m_impl->m_shouldSort) sort();
+    if (m_impl->m_profiler.m_enabled) beginProfilerFrame(*m_impl);
+    if (m_impl->m_gpuTimers.m_requested) beginGPUTimerFrame(*m_impl);
     
     m_impl->m_hideInvisible = GameManager::get()->getGameVariable("0121");
-    const auto& objectLayer = m_impl->m_drawGridLayer->m_editorLayer->m_objectLayer;
-    const auto& gameState = m_impl->m_drawGridLayer->m_editorLayer->m_gameState;
-    const auto& levelSettings = m_impl->m_drawGridLayer->m_editorLayer->m_levelSettings;
-    
-    const CCSize winSize = CCDirector::get()->getWinSize();
-    const float scale = objectLayer->getScale();
-    const CCPoint cameraPos = -objectLayer->getPosition() / scale;
-    
-    const float height = (levelSettings->m_dynamicLevelHeight ? m_impl->m_gridHeightMax : MAX_HEIGHT);
-    const float halfWorldWidth = m_impl->m_cachedWorldViewSize.width * 0.5f;
-    const float halfWorldHeight = m_impl->m_cachedWorldViewSize.height * 0.5f;
     
-    const float visibleMinX = std::max(cameraPos.x - halfWorldWidth - PADDING, m_impl->m_gridWidthMin);
-    const float visibleMaxX = std::min(cameraPos.x + halfWorldWidth + PADDING, m_impl->m_gridWidthMax);
-    const float visibleMinY = std::max(cameraPos.y - halfWorldHeight - PADDING, m_impl->m_gridHeightMin);
-    const float visibleMaxY = std::min(cameraPos.y + halfWorldHeight + PADDING, height);
+    // a frame that threw never got to hand the view back, and the getters have to read the live one here
+    m_impl->m_frameView.m_active = false;
+    const ViewCamera camera = currentCamera(*m_impl);
+    m_impl->m_frameView = FrameView{true, camera, getPixelsPerUnit()};
+    {
+        TraceScope trace(*m_impl, "view", "computeViewPolygon");
+        m_impl->m_viewPolygon = computeViewPolygon(camera);
+        m_impl->m_visibleRect = viewBounds(*m_impl, m_impl->m_viewPolygon);
+    }
+    syncTriggerTables(*m_impl);
+    updateStaticCache(*m_impl, camera);
+    drawDegradedNodes(*m_impl, camera);
+    const float visibleMinX = m_impl->m_visibleRect.getMinX();
+    const float visibleMaxX = m_impl->m_visibleRect.getMaxX();
+    const float visibleMinY = m_impl->m_visibleRect.getMinY();
+    const float visibleMaxY = m_impl->m_visibleRect.getMaxY();
+
+    // a context with a view of its own maps its camera into its viewport of whatever node is drawing it
+    const auto& view = m_impl->m_view;
+    if (view.m_enabled) {
+        kmGLMatrixMode(KM_GL_MODELVIEW);
+        kmGLPushMatrix();
+        kmGLTranslatef(view.m_viewport.getMidX(), view.m_viewport.getMidY(), 0);
+        kmGLRotatef(camera.m_angle, 0, 0, 1);
+        kmGLScalef(camera.m_scale, camera.m_scale, 1);
+        kmGLTranslatef(-camera.m_center.x, -camera.m_center.y, 0);
+    }
 
     m_impl->m_shader->use();
     m_impl->m_shader->setUniformsForBuiltins();
@@ -657,15 +923,69 @@ void DrawGridAPI::draw() {
     ccGLEnableVertexAttribs(kCCVertexAttribFlag_Position | kCCVertexAttribFlag_Color);
     ccGLBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     
-    for (const auto& drawNode : m_impl->m_drawNodes) {
-        if (drawNode->isEnabled()) {
-            drawNode->draw(m_impl->m_drawGridLayer, visibleMinX, visibleMaxX, visibleMinY, visibleMaxY);
+    using Clock = std::chrono::steady_clock;
+
+    /*
+        When pipelined, the batch built last frame is submitted while the workers build this frame's
+        geometry from the view captured above, so what's on screen lags the editor by one frame. The
+        render thread nodes run after the submit on purpose: their custom draws, like the marker textures,
+        are then drawn by the next frame's submit along with the rest of their geometry instead of a frame
+        ahead of it.
+    */
+    if (m_impl->m_pipelinedDraw) {
+        const auto generateStart = Clock::now();
+        launchWorkerNodes(*m_impl, visibleMinX, visibleMaxX, visibleMinY, visibleMaxY);
+
+        const auto submitStart = Clock::now();
+        batchDraw();
+        const auto submitEnd = Clock::now();
+
+        drawRenderThreadNodes(*m_impl, visibleMinX, visibleMaxX, visibleMinY, visibleMaxY);
+        mergeNodeBuffers(*m_impl);
+        drawSubmittedBatches(*this, *m_impl);
+
+        const auto frameEnd = Clock::now();
+        recordFrameTimings(*m_impl, (frameEnd - generateStart) - (submitEnd - submitStart), submitEnd - submitStart, frameEnd - frameStart);
+    }
+    else {
+        const auto generateStart = Clock::now();
+        if (m_impl->m_parallelDraw) {
+            launchWorkerNodes(*m_impl, visibleMinX, visibleMaxX, visibleMinY, visibleMaxY);
+            drawRenderThreadNodes(*m_impl, visibleMinX, visibleMaxX, visibleMinY, visibleMaxY);
+            mergeNodeBuffers(*m_impl);
+        }
+        else {
+            for (size_t i = 0; i < m_impl->m_drawNodes.size(); ++i) {
+                const DrawNode& drawNode = *m_impl->m_drawNodes[i];
+                if (!drawNode.isEnabled() || drawnFromStaticCache(*m_impl, drawNode)) continue;
+                if (!reuseDegradedGeometry(*m_impl, drawNode, m_impl->m_buffers)) {
+                    drawNodeProfiled(*m_impl, i, m_impl->m_buffers, visibleMinX, visibleMaxX, visibleMinY, visibleMaxY);
+                }
+            }
         }
+        drawSubmittedBatches(*this, *m_impl);
+
+        const auto submitStart = Clock::now();
+        drawStaticCache(*m_impl);
+        batchDraw();
+        const auto frameEnd = Clock::now();
+        recordFrameTimings(*m_impl, submitStart - generateStart, frameEnd - submitStart, frameEnd - frameStart);
     }
-    
-    batchDraw();
 
+    updateScheduler(*m_impl, m_impl->m_frameTimings.totalMs);
+    if (m_impl->m_profiler.m_enabled) endProfilerFrame(*m_impl, m_impl->m_frameTimings.totalMs);
+    if (m_impl->m_trace.m_enabled) {
+        recordTraceEvent(*m_impl, "frame", "draw", frameStart, std::chrono::steady_clock::now(), fmt::format("\"frame\":{}", m_impl->m_frameNumber.load(std::memory_order_relaxed)));
+    }
+    m_impl->m_drawLoopAllocations = takeDrawLoopAllocations();
+    m_impl->m_frameNumber.fetch_add(1, std::memory_order_relaxed);
+    m_impl->m_frameView.m_active = false;
     ccGLBlendFunc(oldSrc, oldDst);
+
+    if (view.m_enabled) {
+        kmGLMatrixMode(KM_GL_MODELVIEW);
+        kmGLPopMatrix();
+    }
 }
 
 float DrawGridAPI::getMinPortalY() {
@@ -673,10 +993,10 @@ float DrawGridAPI::getMinPortalY() {
     if (!editor) return 0;
 
     if (editor->m_playbackMode == PlaybackMode::Playing) {
-        m_impl->m_minPortalY = editor->getMinPortalY();
+        m_impl->m_level->m_minPortalY = editor->getMinPortalY();
     }
 
-    return m_impl->m_minPortalY;
+    return m_impl->m_level->m_minPortalY;
 }
 
 float DrawGridAPI::getMaxPortalY() {
@@ -684,8 +1004,8 @@ float DrawGridAPI::getMaxPortalY() {
     if (!editor) return 0;
 
     if (editor->m_playbackMode == PlaybackMode::Playing) {
-        m_impl->m_maxPortalY = editor->getMaxPortalY();
+        m_impl->m_level->m_maxPortalY = editor->getMaxPortalY();
     }
 
-    return m_impl->m_maxPortalY;
+    return m_impl->m_level->m_maxPortalY;
 }
\ No newline at end of file
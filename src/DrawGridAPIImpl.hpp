@@ -0,0 +1,519 @@
+#pragma once
+
+#include "../include/DrawGridAPI.hpp"
+#include <Geode/Geode.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+class WorkerPool;
+
+// everything a frame's worth of primitives gets batched into, either the main batch or a node's own slot
+struct VertexBuffers {
+    DrawGridAPI::DrawMode m_nextDrawMode = DrawGridAPI::DrawMode::NONE;
+    std::map<float, std::vector<Vertex>> m_lineVertsBuffer;
+    std::map<float, std::vector<Vertex>> m_blendedLineVertsBuffer;
+    std::map<float, std::vector<Vertex>> m_invertedLineVertsBuffer;
+    std::vector<Vertex> m_rectVertsBuffer;
+    std::vector<Vertex> m_blendedRectVertsBuffer;
+    std::vector<Vertex> m_invertedRectVertsBuffer;
+    std::vector<Vertex> m_rectOutlineVertsBuffer;
+    std::vector<Vertex> m_blendedRectOutlineVertsBuffer;
+    std::vector<Vertex> m_invertedRectOutlineVertsBuffer;
+    // scratch memory for whatever draws into these buffers
+    FrameArena m_arena;
+
+    std::map<float, std::vector<Vertex>>& lineBuckets(DrawGridAPI::DrawMode drawMode) {
+        switch (drawMode) {
+            case DrawGridAPI::DrawMode::BLEND: return m_blendedLineVertsBuffer;
+            case DrawGridAPI::DrawMode::INVERT: return m_invertedLineVertsBuffer;
+            default: return m_lineVertsBuffer;
+        }
+    }
+
+    std::vector<Vertex>& lines(DrawGridAPI::DrawMode drawMode, float width) {
+        return lineBuckets(drawMode)[width];
+    }
+
+    std::vector<Vertex>& rects(DrawGridAPI::DrawMode drawMode) {
+        switch (drawMode) {
+            case DrawGridAPI::DrawMode::BLEND: return m_blendedRectVertsBuffer;
+            case DrawGridAPI::DrawMode::INVERT: return m_invertedRectVertsBuffer;
+            default: return m_rectVertsBuffer;
+        }
+    }
+
+    std::vector<Vertex>& rectOutlines(DrawGridAPI::DrawMode drawMode) {
+        switch (drawMode) {
+            case DrawGridAPI::DrawMode::BLEND: return m_blendedRectOutlineVertsBuffer;
+            case DrawGridAPI::DrawMode::INVERT: return m_invertedRectOutlineVertsBuffer;
+            default: return m_rectOutlineVertsBuffer;
+        }
+    }
+
+    // empties every buffer but keeps their capacity for the next frame
+    void reset() {
+        for (auto& [_, v] : m_lineVertsBuffer) v.resize(0);
+        for (auto& [_, v] : m_blendedLineVertsBuffer) v.resize(0);
+        for (auto& [_, v] : m_invertedLineVertsBuffer) v.resize(0);
+        m_rectVertsBuffer.resize(0);
+        m_blendedRectVertsBuffer.resize(0);
+        m_invertedRectVertsBuffer.resize(0);
+        m_rectOutlineVertsBuffer.resize(0);
+        m_blendedRectOutlineVertsBuffer.resize(0);
+        m_invertedRectOutlineVertsBuffer.resize(0);
+        m_arena.reset();
+        m_nextDrawMode = DrawGridAPI::DrawMode::NONE;
+    }
+
+    size_t primitiveCount() const {
+        size_t lines = 0;
+        for (const auto& [_, v] : m_lineVertsBuffer) lines += v.size();
+        for (const auto& [_, v] : m_blendedLineVertsBuffer) lines += v.size();
+        for (const auto& [_, v] : m_invertedLineVertsBuffer) lines += v.size();
+        const size_t rects = m_rectVertsBuffer.size() + m_blendedRectVertsBuffer.size() + m_invertedRectVertsBuffer.size();
+        const size_t outlines = m_rectOutlineVertsBuffer.size() + m_blendedRectOutlineVertsBuffer.size() + m_invertedRectOutlineVertsBuffer.size();
+        return lines / 2 + rects / 6 + outlines / 24;
+    }
+
+    // appends everything in other after what is already batched, keeping other's order
+    void append(const VertexBuffers& other) {
+        auto appendLines = [](std::map<float, std::vector<Vertex>>& to, const std::map<float, std::vector<Vertex>>& from) {
+            for (const auto& [width, verts] : from) {
+                if (verts.empty()) continue;
+                auto& target = to[width];
+                target.insert(target.end(), verts.begin(), verts.end());
+            }
+        };
+        auto appendVerts = [](std::vector<Vertex>& to, const std::vector<Vertex>& from) {
+            to.insert(to.end(), from.begin(), from.end());
+        };
+
+        appendLines(m_lineVertsBuffer, other.m_lineVertsBuffer);
+        appendLines(m_blendedLineVertsBuffer, other.m_blendedLineVertsBuffer);
+        appendLines(m_invertedLineVertsBuffer, other.m_invertedLineVertsBuffer);
+        appendVerts(m_rectVertsBuffer, other.m_rectVertsBuffer);
+        appendVerts(m_blendedRectVertsBuffer, other.m_blendedRectVertsBuffer);
+        appendVerts(m_invertedRectVertsBuffer, other.m_invertedRectVertsBuffer);
+        appendVerts(m_rectOutlineVertsBuffer, other.m_rectOutlineVertsBuffer);
+        appendVerts(m_blendedRectOutlineVertsBuffer, other.m_blendedRectOutlineVertsBuffer);
+        appendVerts(m_invertedRectOutlineVertsBuffer, other.m_invertedRectOutlineVertsBuffer);
+    }
+};
+
+// sends this thread's draw calls into buffers until it goes out of scope
+struct TargetBuffersScope {
+    TargetBuffersScope(VertexBuffers* buffers);
+    ~TargetBuffersScope();
+};
+
+// makes DrawGridAPI::get() return api on this thread until it goes out of scope
+struct CurrentContextScope {
+    DrawGridAPI* m_previous;
+
+    CurrentContextScope(DrawGridAPI* api);
+    ~CurrentContextScope();
+};
+
+// a TriggerTable and what it takes to keep it in sync with the array it copies
+struct TriggerTableState {
+    TriggerTable m_table;
+    cocos2d::CCArray* m_source = nullptr;
+    // where each object's row is, for moving it without going through the whole array
+    std::unordered_map<GameObject*, uint32_t> m_rows;
+    bool m_guides = false;
+    bool m_dirty = true;
+};
+
+// what's worked out from the level once and shared by every context drawing it
+struct LevelData {
+    std::unordered_map<float, cocos2d::ccColor4B> m_timeMarkers;
+    // bumped whenever the time markers are generated again
+    uint64_t m_timeMarkersGeneration = 0;
+    float m_minPortalY = 0;
+    float m_maxPortalY = 0;
+    TriggerTableState m_effectTriggers;
+    TriggerTableState m_durationTriggers;
+    TriggerTableState m_guideTriggers;
+
+    LevelData() {
+        m_guideTriggers.m_guides = true;
+    }
+};
+
+// where a context is looking, either the editor's camera or one set with setView
+struct ViewCamera {
+    cocos2d::CCPoint m_center;
+    cocos2d::CCSize m_size;
+    float m_scale = 1;
+    float m_angle = 0;
+};
+
+/*
+    The view as it was when the frame started, which the view getters hand out until it ends. Worker nodes
+    read it instead of the editor's object layer and the director, so every node in a frame sees the same view
+    and nothing off the render thread touches cocos.
+*/
+struct FrameView {
+    bool m_active = false;
+    ViewCamera m_camera;
+    float m_pixelsPerUnit = 0;
+};
+
+struct ContextView {
+    bool m_enabled = false;
+    cocos2d::CCRect m_viewport;
+    cocos2d::CCPoint m_center;
+    float m_scale = 1;
+    float m_angle = 0;
+};
+
+// one entry of the lock free submission stack, pushed by any thread and drained by the render thread
+struct SubmittedBatch {
+    std::string m_channel;
+    uint64_t m_generation = 0;
+    bool m_clear = false;
+    DrawGridAPI::DrawBatch m_batch;
+    SubmittedBatch* m_next = nullptr;
+};
+
+struct ChannelBatch {
+    uint64_t m_generation = 0;
+    DrawGridAPI::DrawBatch m_batch;
+};
+
+using PrimitiveKind = DrawGridAPI::PrimitiveKind;
+
+// persistent primitives are bucketed by how they're drawn and by which stretch of the level they're in
+struct PersistentBucketKey {
+    DrawGridAPI::DrawMode m_drawMode;
+    PrimitiveKind m_kind;
+    float m_width;
+    int m_chunk;
+
+    auto operator<=>(const PersistentBucketKey&) const = default;
+};
+
+struct PersistentBucket {
+    std::vector<Vertex> m_vertices;
+    // the slot owning each primitive, for fixing up handles when the last primitive fills a removed one's place
+    std::vector<uint32_t> m_owners;
+    GLuint m_vbo = 0;
+    bool m_dirty = true;
+    cocos2d::CCRect m_bounds;
+    // set when a primitive moved or went away, the bounds are worked out again before they're next used
+    bool m_boundsStale = false;
+};
+
+struct PersistentSlot {
+    uint32_t m_generation = 1;
+    bool m_alive = false;
+    PersistentBucketKey m_key;
+    uint32_t m_position = 0;
+};
+
+struct PersistentStore {
+    std::map<PersistentBucketKey, PersistentBucket> m_buckets;
+    std::vector<PersistentSlot> m_slots;
+    std::vector<uint32_t> m_freeSlots;
+    size_t m_count = 0;
+};
+
+// how many frames the profiler keeps, a few seconds worth
+constexpr size_t PROFILER_HISTORY_SIZE = 240;
+
+struct ProfilerState {
+    bool m_enabled = false;
+    // fixed size ring, m_next is where the next finished frame goes
+    std::vector<DrawGridAPI::ProfilerFrame> m_history;
+    size_t m_next = 0;
+    size_t m_size = 0;
+    DrawGridAPI::ProfilerFrame m_current;
+};
+
+// timer results are read this many frames late so checking them never waits on the GPU
+constexpr size_t GPU_TIMER_LATENCY = 4;
+
+struct GPUTimerFrame {
+    uint64_t m_frame = 0;
+    std::vector<GLuint> m_queries;
+    size_t m_used = 0;
+    bool m_pending = false;
+};
+
+struct GPUTimerState {
+    bool m_requested = false;
+    // -1 until checked against the context, timer queries aren't core in every GL we run on
+    int m_supported = -1;
+    // requested, supported and profiling, decided once per frame
+    bool m_active = false;
+    std::array<GPUTimerFrame, GPU_TIMER_LATENCY> m_frames;
+};
+
+struct TraceEvent {
+    std::string m_name;
+    const char* m_category;
+    // microseconds since the trace started
+    double m_start;
+    double m_duration;
+    uint32_t m_thread;
+    // the contents of the event's args object, already JSON
+    std::string m_args;
+};
+
+struct TraceState {
+    bool m_enabled = false;
+    // nodes drawn on workers record their spans too
+    std::mutex m_mutex;
+    std::chrono::steady_clock::time_point m_origin;
+    // fixed size ring like the profiler's, the oldest events are dropped once it's full
+    std::vector<TraceEvent> m_events;
+    size_t m_capacity = 0;
+    size_t m_next = 0;
+    size_t m_size = 0;
+    std::unordered_map<std::thread::id, uint32_t> m_threads;
+};
+
+struct CapturedBucket {
+    DrawGridAPI::DrawMode m_drawMode;
+    PrimitiveKind m_kind;
+    float m_width;
+    std::vector<Vertex> m_vertices;
+};
+
+struct CapturedFrame {
+    uint64_t m_frame = 0;
+    cocos2d::CCRect m_bounds;
+    std::vector<CapturedBucket> m_buckets;
+};
+
+struct CaptureState {
+    // frames left to capture
+    int m_remaining = 0;
+    std::vector<CapturedFrame> m_frames;
+};
+
+struct BufferBucketKey {
+    DrawGridAPI::DrawMode m_drawMode;
+    PrimitiveKind m_kind;
+    float m_width;
+
+    auto operator<=>(const BufferBucketKey&) const = default;
+};
+
+struct BufferBucketUsage {
+    size_t m_used = 0;
+    // the most used during the current run of quiet frames
+    size_t m_peak = 0;
+    int m_quietFrames = 0;
+};
+
+/*
+    A frame is quiet for a bucket when it uses less than half of what the bucket has reserved. After enough
+    quiet frames in a row the bucket shrinks back to what those frames needed, and going over the budget
+    shrinks everything to the current frame straight away.
+*/
+struct MemoryPolicy {
+    size_t m_budget = 64 * 1024 * 1024;
+    int m_shrinkDelay = 300;
+    std::map<BufferBucketKey, BufferBucketUsage> m_usage;
+};
+
+// everything the cached layers were drawn with that the texture can't follow, any change draws it again
+struct StaticCacheKey {
+    float m_scale = 0;
+    float m_angle = 0;
+    cocos2d::CCSize m_size;
+    uint64_t m_content = 0;
+
+    bool operator==(const StaticCacheKey& other) const {
+        return m_scale == other.m_scale && m_angle == other.m_angle && m_size.width == other.m_size.width && m_size.height == other.m_size.height && m_content == other.m_content;
+    }
+};
+
+struct StaticCache {
+    bool m_enabled = false;
+    float m_margin = 0.25f;
+    bool m_dirty = true;
+    // the cached layers drew blended or inverted geometry, which only looks right drawn straight to the screen
+    bool m_unsupported = false;
+    // the cached layers come from the texture this frame and are left out of the batch
+    bool m_active = false;
+    StaticCacheKey m_key;
+    // where the texture was drawn from, its corners in level space in the same order as ViewPolygon's
+    ViewCamera m_camera;
+    std::array<cocos2d::CCPoint, 4> m_corners;
+    geode::Ref<cocos2d::CCRenderTexture> m_texture = nullptr;
+    VertexBuffers m_buffers;
+    DrawGridAPI::StaticCacheStats m_stats;
+};
+
+struct ScheduledNode {
+    // drawn every 1 << m_level frames, its geometry is reused in between
+    int m_level = 0;
+    // smoothed time a draw takes
+    float m_costMs = 0;
+    // custom draws only last a frame, so nodes that queue them are never degraded
+    bool m_reusable = true;
+    bool m_hasGeometry = false;
+    uint64_t m_drawnFrame = 0;
+    // the view the geometry was drawn for, grown so panning doesn't run off its edge straight away
+    ViewCamera m_camera;
+    VertexBuffers m_geometry;
+};
+
+struct FrameScheduler {
+    float m_budgetMs = 0;
+    float m_smoothedMs = 0;
+    int m_overFrames = 0;
+    int m_underFrames = 0;
+    // only added to on the render thread, workers look their node up while drawing
+    std::unordered_map<const DrawNode*, ScheduledNode> m_nodes;
+};
+
+struct DrawGridAPIImpl {
+    float m_gridWidthMin = -3000.f;
+    float m_gridHeightMin = -3000.f;
+    float m_gridWidthMax = 240000.f;
+    float m_gridHeightMax = 30090.f;
+    bool m_vanillaDraw = false;
+    bool m_hideInvisible = false;
+    bool m_lineSmoothing = false;
+    float m_lineSmoothingLimit = 0.4f;
+    bool m_dirtyViewTransform = true;
+    bool m_shouldSort = true;
+    bool m_invertGrid = false;
+    bool m_parallelDraw = false;
+    bool m_pipelinedDraw = false;
+    bool m_optimizeGeometry = true;
+    DrawGridAPI::ColumnAggregation m_columnAggregation = DrawGridAPI::ColumnAggregation::OFF;
+    float m_cachedOverdrawFactor = 1.f;
+
+    cocos2d::CCSize m_cachedWorldViewSize;
+    cocos2d::CCGLProgram* m_shader = nullptr;
+    std::shared_ptr<LevelData> m_level = std::make_shared<LevelData>();
+    ContextView m_view;
+    // the DrawGridAPI this belongs to, for pointing DrawGridAPI::get() at it on worker threads
+    DrawGridAPI* m_api = nullptr;
+    FrameTimings m_frameTimings;
+    VertexBuffers m_buffers;
+    std::vector<VertexBuffers> m_nodeBuffers;
+    std::unique_ptr<WorkerPool> m_workerPool;
+    std::atomic<SubmittedBatch*> m_submittedBatches = nullptr;
+    std::atomic<uint64_t> m_frameNumber = 0;
+    std::unordered_map<std::string, ChannelBatch> m_channelBatches;
+    std::vector<std::function<void()>> m_customDraws;
+    PersistentStore m_persistent;
+    ProfilerState m_profiler;
+    GPUTimerState m_gpuTimers;
+    TraceState m_trace;
+    CaptureState m_capture;
+    MemoryPolicy m_memory;
+    DrawGridAPI::GeometryStats m_geometryStats;
+    StaticCache m_staticCache;
+    FrameScheduler m_scheduler;
+    size_t m_drawLoopAllocations = 0;
+    cocos2d::CCRect m_visibleRect;
+    ViewPolygon m_viewPolygon;
+    FrameView m_frameView;
+    DrawGridLayer* m_drawGridLayer = nullptr;
+    std::vector<std::unique_ptr<DrawNode>> m_drawNodes;
+    std::unordered_map<std::string, DrawNode*> m_nodesByID;
+    // filled in as getNode<T>() gets asked for types, emptied whenever nodes are added or reordered
+    std::unordered_map<std::type_index, DrawNode*> m_nodesByType;
+
+    // the buffers draw calls on this thread should go to, a node's own slot while it draws in parallel mode
+    VertexBuffers& targetBuffers();
+
+    ~DrawGridAPIImpl();
+};
+
+static inline float percentile99(std::vector<float>& samples) {
+    if (samples.empty()) return 0;
+    const size_t index = (samples.size() * 99 + 99) / 100 - 1;
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+void beginProfilerFrame(DrawGridAPIImpl& impl);
+void endProfilerFrame(DrawGridAPIImpl& impl, float totalMs);
+void drawNodeProfiled(DrawGridAPIImpl& impl, size_t index, VertexBuffers& buffers, float minX, float maxX, float minY, float maxY);
+ViewCamera currentCamera(const DrawGridAPIImpl& impl);
+// the view turned with the camera around center, the world point in the middle of it
+ViewPolygon computeViewPolygon(const ViewCamera& camera);
+// whether inner's view fits inside outer's, both have to have the same zoom and rotation
+bool viewContains(const ViewCamera& outer, const ViewCamera& inner);
+float levelHeight(const DrawGridAPIImpl& impl);
+// the polygon's bounds plus a few pixels, clamped to the grid
+cocos2d::CCRect viewBounds(const DrawGridAPIImpl& impl, const ViewPolygon& polygon);
+void growBoundsForNode(const DrawGridAPIImpl& impl, const DrawNode& drawNode, float& minX, float& maxX, float& minY, float& maxY);
+// clips every line written to buffer from offset on, dropping the ones that are off screen
+void clipLineRun(const ViewPolygon& polygon, std::vector<Vertex>& buffer, size_t offset, float width);
+void recordDrawCall(DrawGridAPIImpl& impl, DrawGridAPI::DrawMode drawMode, PrimitiveKind kind, float width, size_t vertices);
+
+// counts heap allocations on this thread while alive, only in builds with GOOD_GRID_COUNT_DRAW_ALLOCATIONS
+struct DrawLoopAllocationScope {
+    bool m_previous;
+
+    DrawLoopAllocationScope();
+    ~DrawLoopAllocationScope();
+};
+
+// how many allocations were counted since the last call
+size_t takeDrawLoopAllocations();
+
+// call after the buffers are submitted and before they're reset, shrinking throws away what's in them
+void applyMemoryPolicy(DrawGridAPIImpl& impl);
+// call right before the buffers are submitted, once every node has drawn into them
+void optimizeGeometry(DrawGridAPIImpl& impl);
+
+// decides whether the cached layers come from the texture this frame, drawing it again first if it has to
+void updateStaticCache(DrawGridAPIImpl& impl, const ViewCamera& camera);
+// call before the batch is drawn so everything else ends up on top
+void drawStaticCache(DrawGridAPIImpl& impl);
+bool drawnFromStaticCache(const DrawGridAPIImpl& impl, const DrawNode& drawNode);
+
+// redraws the degraded nodes that are due, call before any node draws this frame
+void drawDegradedNodes(DrawGridAPIImpl& impl, const ViewCamera& camera);
+// appends the node's last geometry to buffers instead of drawing it if it's degraded
+bool reuseDegradedGeometry(DrawGridAPIImpl& impl, const DrawNode& drawNode, VertexBuffers& buffers);
+void recordNodeCost(DrawGridAPIImpl& impl, const DrawNode& drawNode, float ms, bool queuedCustomDraws);
+void updateScheduler(DrawGridAPIImpl& impl, float frameMs);
+
+// brings the trigger tables up to date with the editor's arrays, call before any node draws this frame
+void syncTriggerTables(DrawGridAPIImpl& impl);
+
+void beginGPUTimerFrame(DrawGridAPIImpl& impl);
+void beginGPUTimer(DrawGridAPIImpl& impl);
+void endGPUTimer(DrawGridAPIImpl& impl);
+void resetGPUTimers(DrawGridAPIImpl& impl);
+
+void recordTraceEvent(DrawGridAPIImpl& impl, const char* category, std::string name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end, std::string args = {});
+
+// records a span from construction to destruction while tracing
+struct TraceScope {
+    DrawGridAPIImpl& m_impl;
+    const char* m_category;
+    const char* m_name;
+    bool m_active;
+    std::chrono::steady_clock::time_point m_start;
+
+    TraceScope(DrawGridAPIImpl& impl, const char* category, const char* name)
+        : m_impl(impl), m_category(category), m_name(name), m_active(impl.m_trace.m_enabled) {
+        if (m_active) m_start = std::chrono::steady_clock::now();
+    }
+
+    ~TraceScope() {
+        if (m_active) recordTraceEvent(m_impl, m_category, m_name, m_start, std::chrono::steady_clock::now());
+    }
+};
+
+void submitBuffers(DrawGridAPIImpl& impl, VertexBuffers& buffers, float widthModifier, bool persistent);
+void captureFrame(DrawGridAPIImpl& impl);
+void capturePersistentPrimitives(DrawGridAPIImpl& impl, CapturedFrame& frame);
+
+void drawPersistentPrimitives(DrawGridAPIImpl& impl, DrawGridAPI::DrawMode drawMode, float widthModifier);
+void forgetPersistentBuffers(DrawGridAPIImpl& impl);
+
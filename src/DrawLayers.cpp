@@ -1,9 +1,34 @@
 #include "../include/DrawLayers.hpp"
 #include "../include/DrawGridAPI.hpp"
+#include "MarkerTexture.hpp"
+#include <cstring>
 #include <Geode/Geode.hpp>
 
 using namespace geode::prelude;
 
+static constexpr float DEFAULT_LOD_SPACING = 4.0f;
+static constexpr int MAX_LOD_STEP = 1 << 20;
+
+static int floorDiv(int a, int b) {
+    return a / b - (a % b != 0 && a < 0);
+}
+
+static int ceilDiv(int a, int b) {
+    return -floorDiv(-a, b);
+}
+
+static LineColor withAlpha(const LineColor& color, float factor) {
+    ccColor4B colorA = color.getColorA();
+    ccColor4B colorB = color.getColorB();
+    colorA.a = static_cast<GLubyte>(colorA.a * factor);
+    colorB.a = static_cast<GLubyte>(colorB.a * factor);
+    return {colorA, colorB};
+}
+
+void Grid::init(DrawGridLayer* dgl) {
+    setLODSpacing(Mod::get()->getSettingValue<bool>("grid-lod") ? DEFAULT_LOD_SPACING : 0);
+}
+
 void Grid::draw(DrawGridLayer* dgl, float minX, float maxX, float minY, float maxY) {
     auto editorLayer = dgl->m_editorLayer;
 
@@ -15,7 +40,7 @@ void Grid::draw(DrawGridLayer* dgl, float minX, float maxX, float minY, float ma
     const CCSize size = api.getGridBoundsSize();
     const CCPoint origin = api.getGridBoundsOrigin();
 
-    const float scale = editorLayer->m_objectLayer->getScale();
+    const float scale = api.getViewScale();
     const float xStart = std::max(minX - gridSize, origin.x);
     const float xEnd   = std::min(maxX + gridSize, size.width);
     
@@ -30,27 +55,38 @@ void Grid::draw(DrawGridLayer* dgl, float minX, float maxX, float minY, float ma
     const int firstGridY = static_cast<int>(std::floor(yStart * invGridSize));
     const int lastGridY  = static_cast<int>(std::floor(yEnd * invGridSize)) - 1;
     
-    float x = firstGridX * gridSize + gridSize;
-
-    if (api.invertGrid()) {
-        for (int i = firstGridX; i <= lastGridX; ++i, x += gridSize) {
-            api.drawLineV2({x, minY}, {x, maxY}, m_gridColor, m_lineWidth, DrawGridAPI::DrawMode::INVERT);
-        }
-
-        float y = firstGridY * gridSize + gridSize;
-        for (int i = firstGridY; i <= lastGridY; ++i, y += gridSize) {
-            api.drawLineV2({minX, y}, {maxX, y}, m_gridColor, m_lineWidth, DrawGridAPI::DrawMode::INVERT);
-        }
+    const auto drawMode = api.invertGrid() ? DrawGridAPI::DrawMode::INVERT : DrawGridAPI::DrawMode::NORMAL;
+
+    // draws the lines on every multiple of every cells
+    auto drawEvery = [&](int every, const LineColor& color, int accentEvery = 0, const LineColor& accentColor = {}) {
+        const float spacing = gridSize * every;
+        api.drawVerticalLines(0, spacing, ceilDiv(firstGridX + 1, every), floorDiv(lastGridX + 1, every), minY, maxY, color, m_lineWidth, drawMode, accentEvery, accentColor);
+        api.drawHorizontalLines(0, spacing, ceilDiv(firstGridY + 1, every), floorDiv(lastGridY + 1, every), minX, maxX, color, m_lineWidth, drawMode, accentEvery, accentColor);
+    };
+
+    /*
+        Zoomed out far enough, only every step-th line is kept so the line count follows the screen instead
+        of the level. The lines the next step drops are faded as they get closer instead of popping out.
+    */
+    const float screenSpacing = gridSize * scale;
+    int step = 1;
+    while (m_lodSpacing > 0 && screenSpacing * step < m_lodSpacing && step < MAX_LOD_STEP) step *= 2;
+
+    if (step == 1) {
+        drawEvery(1, m_gridColor);
     }
     else {
-        for (int i = firstGridX; i <= lastGridX; ++i, x += gridSize) {
-            api.drawLine({x, minY}, {x, maxY}, m_gridColor, m_lineWidth);
-        }
+        const float halfSpacing = m_lodSpacing * 0.5f;
+        const float fade = std::clamp((screenSpacing * step * 0.5f - halfSpacing) / halfSpacing, 0.f, 1.f);
+        if (fade > 0) drawEvery(step / 2, withAlpha(m_gridColor, fade), 2, m_gridColor);
+        else drawEvery(step, m_gridColor);
+    }
 
-        float y = firstGridY * gridSize + gridSize;
-        for (int i = firstGridY; i <= lastGridY; ++i, y += gridSize) {
-            api.drawLine({minX, y}, {maxX, y}, m_gridColor, m_lineWidth);
-        }
+    // drawn over the regular lines, and thinned out the same way without fading
+    if (m_majorEvery > 0) {
+        int majorEvery = m_majorEvery;
+        while (m_lodSpacing > 0 && screenSpacing * majorEvery < m_lodSpacing && majorEvery < MAX_LOD_STEP) majorEvery *= 2;
+        drawEvery(majorEvery, m_majorColor);
     }
 }
 
@@ -84,6 +120,41 @@ float Grid::getLineWidth() const {
     return m_lineWidth;
 }
 
+void Grid::setLODSpacing(float spacing, int priority) {
+    if (priority >= m_lodSpacingPriority) {
+        m_lodSpacing = spacing;
+        m_lodSpacingPriority = priority;
+    }
+}
+
+int Grid::getLODSpacingPriority() const {
+    return m_lodSpacingPriority;
+}
+
+float Grid::getLODSpacing() const {
+    return m_lodSpacing;
+}
+
+void Grid::setMajorLines(int every, const LineColor& color, int priority) {
+    if (priority >= m_majorLinesPriority) {
+        m_majorEvery = every;
+        m_majorColor = color;
+        m_majorLinesPriority = priority;
+    }
+}
+
+int Grid::getMajorLinesPriority() const {
+    return m_majorLinesPriority;
+}
+
+int Grid::getMajorLinesEvery() const {
+    return m_majorEvery;
+}
+
+const LineColor& Grid::getMajorLineColor() const {
+    return m_majorColor;
+}
+
 void Bounds::draw(DrawGridLayer* dgl, float minX, float maxX, float minY, float maxY) {
     auto& api = DrawGridAPI::get();
 
@@ -267,9 +338,14 @@ void GuideObjects::draw(DrawGridLayer* dgl, float minX, float maxX, float minY,
 
     m_colorsForObject.rebuildIfNeeded();
 
-    for (auto obj : CCArrayExt<EffectGameObject*>(dgl->m_guideObjects)) {
+    auto writer = api.getLineWriter<DrawGridAPI::DrawMode::NORMAL>(2.0f);
+
+    const TriggerTable& guides = api.getGuideTriggers();
+    for (size_t i = 0; i < guides.size(); ++i) {
+        auto [y1, y2] = guides.portalRanges[i];
+        if ((y1 < minY || y1 > maxY) && (y2 < minY || y2 > maxY)) continue;
+        auto obj = static_cast<EffectGameObject*>(guides.objects[i]);
         if (!api.isObjectVisible(obj)) continue;
-        auto [y1, y2] = api.getPortalMinMax(obj);
 
         static const auto defaultLineColor = LineColor{0, 255, 255, 255};
 
@@ -282,14 +358,48 @@ void GuideObjects::draw(DrawGridLayer* dgl, float minX, float maxX, float minY,
         for (auto& fn : m_colorsForObject.flat) {
             fn(bottomColor, topColor, obj, lineWidthBottom, lineWidthTop);
         }
+        countCallbacks(m_colorsForObject.flat.size());
 
-        if (y1 >= minY && y1 <= maxY) api.drawLine({minX, y1}, {maxX, y1}, bottomColor, lineWidthBottom);
-        if (y2 >= minY && y2 <= maxY) api.drawLine({minX, y2}, {maxX, y2}, topColor, lineWidthTop);
+        if (y1 >= minY && y1 <= maxY) writer.drawLine({minX, y1}, {maxX, y1}, bottomColor, lineWidthBottom);
+        if (y2 >= minY && y2 <= maxY) writer.drawLine({minX, y2}, {maxX, y2}, topColor, lineWidthTop);
     }
 }
 
+// callbacks from other mods can't be assumed to be thread safe
 void GuideObjects::setPropertiesForObject(GuideObjectCallback colorForObject, int priority) {
     m_colorsForObject.add(std::move(colorForObject), priority);
+    setRenderThreadOnly(true);
+}
+
+// the texture is drawn after the batch, so it sits above the lines of every node
+static void drawMarkerTexture(DrawGridAPI& api, const std::shared_ptr<MarkerTexture>& markerTexture, float minX, float maxX, float minY, float maxY) {
+    api.addCustomDraw([markerTexture, minX, maxX, minY, maxY, pixelsPerUnit = api.getPixelsPerUnit()] {
+        markerTexture->draw(minX, maxX, minY, maxY, pixelsPerUnit);
+    });
+}
+
+static void mix(uint64_t& hash, uint64_t value) {
+    hash = (hash ^ value) * 0x100000001b3ull;
+}
+
+/*
+    Everything that decides which effect lines the texture holds when there are no callbacks. Edits go through
+    the trigger table, hidden objects depend on the setting, and a selected one shows its line while hidden.
+*/
+static uint64_t effectTextureInputs(DrawGridAPI& api, DrawGridLayer* dgl, const TriggerTable& triggers) {
+    auto editorLayer = dgl->m_editorLayer;
+    auto editorUI = editorLayer->m_editorUI;
+    uint64_t hash = 0xcbf29ce484222325ull;
+    mix(hash, triggers.generation);
+    mix(hash, api.isHideInvisible());
+    mix(hash, editorLayer->m_undoObjects ? editorLayer->m_undoObjects->count() : 0);
+    mix(hash, reinterpret_cast<uintptr_t>(editorUI->m_selectedObject));
+    mix(hash, editorUI->m_selectedObjects ? editorUI->m_selectedObjects->count() : 0);
+    return hash;
+}
+
+void EffectLines::init(DrawGridLayer* dgl) {
+    setTextureMode(Mod::get()->getSettingValue<bool>("marker-texture"));
 }
 
 void EffectLines::draw(DrawGridLayer* dgl, float minX, float maxX, float minY, float maxY) {
@@ -300,10 +410,38 @@ void EffectLines::draw(DrawGridLayer* dgl, float minX, float maxX, float minY, f
 
     m_colorsForObject.rebuildIfNeeded();
 
-    for (auto obj : CCArrayExt<EffectGameObject*>(dgl->m_effectGameObjects)) {
-        if (obj->m_isSpawnTriggered || obj->m_isTouchTriggered || !api.isObjectVisible(obj)) continue;
-        float x = obj->getPositionX();
-        if (x < minX || x > maxX || x < 0) continue;
+    auto writer = api.getLineWriter<DrawGridAPI::DrawMode::NORMAL>(1.0f);
+    const bool aggregate = api.getColumnAggregation() != DrawGridAPI::ColumnAggregation::OFF;
+    DrawGridAPI::ColumnAggregator columns(api);
+
+    const TriggerTable& triggers = api.getEffectTriggers();
+
+    /*
+        Callbacks could color and move every line differently each frame, and filling the texture would mean
+        running them over the whole level. While there are any, only the visible lines are drawn, the same way
+        as without the texture. Without them only an edit changes what the texture holds.
+    */
+    const bool textureMode = m_textureMode && m_colorsForObject.empty();
+    bool fillTexture = false;
+    if (textureMode) {
+        if (!m_markerTexture) m_markerTexture = std::make_shared<MarkerTexture>(0.f);
+        fillTexture = m_markerTexture->needsUpdate(effectTextureInputs(api, dgl, triggers));
+        if (fillTexture) {
+            m_markerTexture->beginUpdate();
+            m_outsideTexture.clear();
+        }
+    }
+
+    // an up to date texture is drawn as it is, along with the lines it couldn't hold
+    const size_t count = textureMode && !fillTexture ? 0 : triggers.size();
+    for (size_t i = 0; i < count; ++i) {
+        if (triggers.flags[i] & (TriggerTable::SPAWN_TRIGGERED | TriggerTable::TOUCH_TRIGGERED)) continue;
+        float x = triggers.x[i];
+        // the texture holds every line, not just the visible ones, so panning doesn't change it
+        if (!textureMode && (x < minX || x > maxX)) continue;
+        if (x < 0) continue;
+        auto obj = static_cast<EffectGameObject*>(triggers.objects[i]);
+        if (!api.isObjectVisible(obj)) continue;
 
         static const auto defaultLineColor = LineColor{0, 255, 255, 255};
 
@@ -314,13 +452,51 @@ void EffectLines::draw(DrawGridLayer* dgl, float minX, float maxX, float minY, f
         for (auto& fn : m_colorsForObject.flat) {
             fn(color, x, obj, lineWidth);
         }
+        countCallbacks(m_colorsForObject.flat.size());
 
-        api.drawLine({x, minY}, { x, maxY}, color, lineWidth);
+        if (textureMode) {
+            if (!m_markerTexture->setMarker(reinterpret_cast<uintptr_t>(obj), x, color.getColorA(), lineWidth)) {
+                m_outsideTexture.push_back({x, color, lineWidth});
+            }
+            continue;
+        }
+
+        if (aggregate) columns.drawLine(x, color, lineWidth);
+        else writer.drawLine({x, minY}, {x, maxY}, color, lineWidth);
+    }
+
+    if (textureMode) {
+        for (const auto& line : m_outsideTexture) {
+            if (line.m_x < minX || line.m_x > maxX) continue;
+            if (aggregate) columns.drawLine(line.m_x, line.m_color, line.m_width);
+            else writer.drawLine({line.m_x, minY}, {line.m_x, maxY}, line.m_color, line.m_width);
+        }
+    }
+    if (aggregate) columns.flush(minY, maxY);
+
+    if (textureMode) {
+        if (fillTexture) m_markerTexture->endUpdate();
+        drawMarkerTexture(api, m_markerTexture, minX, maxX, minY, maxY);
     }
 }
 
+void EffectLines::setTextureMode(bool enabled) {
+    m_textureMode = enabled;
+    if (!enabled) m_markerTexture = nullptr;
+    // the texture is uploaded while drawing, which has to happen on the render thread
+    setRenderThreadOnly(enabled || !m_colorsForObject.empty());
+    setAlwaysLive(enabled || !m_colorsForObject.empty());
+}
+
+bool EffectLines::isTextureMode() const {
+    return m_textureMode;
+}
+
 void EffectLines::setPropertiesForObject(EffectLineCallback colorForObject, int priority) {
     m_colorsForObject.add(std::move(colorForObject), priority);
+    setRenderThreadOnly(true);
+    // what the callbacks do could change every frame
+    setAlwaysLive(true);
 }
 
 void DurationLines::draw(DrawGridLayer* dgl, float minX, float maxX, float minY, float maxY) {
@@ -337,8 +513,13 @@ void DurationLines::draw(DrawGridLayer* dgl, float minX, float maxX, float minY,
     const auto& updateTimeMarkers = dgl->m_updateTimeMarkers;
     auto speedObjects = dgl->m_speedObjects;
     auto snapObject = editorLayer->m_editorUI->m_snapObject;
+    auto writer = api.getLineWriter<DrawGridAPI::DrawMode::NORMAL>(2.0f);
 
-    for (auto obj : CCArrayExt<EffectGameObject*>(editorLayer->m_durationObjects)) {
+    const TriggerTable& durations = api.getDurationTriggers();
+    for (size_t i = 0; i < durations.size(); ++i) {
+        auto obj = static_cast<EffectGameObject*>(durations.objects[i]);
+        // the same cull as below, before anything is read off the object. When the time markers change every end gets reset
+        if (!updateTimeMarkers && obj != m_lastSnappedObject && (durations.x[i] > maxX || durations.y[i] > maxY)) continue;
         if (!api.isObjectVisible(obj)) continue;
         
         static const auto defaultLineColor = LineColor{100, 100, 100, 75};
@@ -350,6 +531,7 @@ void DurationLines::draw(DrawGridLayer* dgl, float minX, float maxX, float minY,
         for (auto& fn : m_colorsForObject.flat) {
             fn(color, obj, lineWidth);
         }
+        countCallbacks(m_colorsForObject.flat.size());
 
         CCPoint& endPos = obj->m_endPosition;
 
@@ -357,25 +539,18 @@ void DurationLines::draw(DrawGridLayer* dgl, float minX, float maxX, float minY,
             endPos = CCPoint{0, 0};
             m_lastSnappedObject = nullptr;
         }
-        else {
+        else if (m_lastSnappedObject != snapObject) {
+            // assigning a Ref retains and releases even when it's the same object
             m_lastSnappedObject = snapObject;
         }
 
-        float time = obj->m_duration;
-
-        if (obj->m_objectID == 1006) {
-            time = obj->m_fadeInDuration + obj->m_holdDuration + obj->m_fadeOutDuration;
-        }
-        else if (obj->m_objectID == 3602) {
-            SFXTriggerGameObject* sfxTrigger = static_cast<SFXTriggerGameObject*>(obj);
-            time = sfxTrigger->m_soundDuration;
-        }
+        const float time = durations.durations[i];
 
         if ((time <= 0)) continue;
         
-        const CCPoint& currentPos = obj->getPosition();
+        const CCPoint currentPos = {durations.x[i], durations.y[i]};
 
-        if (!obj->m_isSpawnTriggered) {
+        if (!(durations.flags[i] & TriggerTable::SPAWN_TRIGGERED)) {
             if (endPos == CCPointZero) {
                 float currentTime = LevelTools::timeForPos(
                     currentPos,
@@ -426,7 +601,7 @@ void DurationLines::draw(DrawGridLayer* dgl, float minX, float maxX, float minY,
 
         if (endPos.x < minX || currentPos.x > maxX || endPos.y < minY || currentPos.y > maxY) continue;
 
-        api.drawLine({currentPos.x, currentPos.y}, {endPos.x, endPos.y}, color, lineWidth, false);
+        writer.drawLine({currentPos.x, currentPos.y}, {endPos.x, endPos.y}, color, lineWidth);
     }
     dgl->m_updateTimeMarkers = false;
 }
@@ -435,28 +610,99 @@ void DurationLines::setPropertiesForObject(DurationLineCallback colorForObject,
     m_colorsForObject.add(std::move(colorForObject), priority);
 }
 
+void Guidelines::init(DrawGridLayer* dgl) {
+    setTextureMode(Mod::get()->getSettingValue<bool>("marker-texture"));
+}
+
 void Guidelines::draw(DrawGridLayer* dgl, float minX, float maxX, float minY, float maxY) {
     if (!GameManager::get()->m_showSongMarkers) return;
     auto& api = DrawGridAPI::get();
 
     m_colorsForValue.rebuildIfNeeded();
 
-    for (const auto& [k, v] : api.getTimeMarkers()) {
-        LineColor color = v;
-        float x = k;
-        float lineWidth = 1.0f;
+    auto writer = api.getLineWriter<DrawGridAPI::DrawMode::NORMAL>(1.0f);
+    const bool aggregate = api.getColumnAggregation() != DrawGridAPI::ColumnAggregation::OFF;
+    DrawGridAPI::ColumnAggregator columns(api);
+
+    // callbacks could change every marker each frame, so while there are any the markers are drawn the same way as
+    // without the texture. Without them the texture only changes when the markers are generated again
+    const bool textureMode = m_textureMode && m_colorsForValue.empty();
+    bool fillTexture = false;
+    if (textureMode) {
+        if (!m_markerTexture) m_markerTexture = std::make_shared<MarkerTexture>(0.f);
+        fillTexture = m_markerTexture->needsUpdate(api.getTimeMarkersGeneration());
+        if (fillTexture) {
+            m_markerTexture->beginUpdate();
+            m_outsideTexture.clear();
+        }
+    }
+
+    if (!textureMode || fillTexture) {
+        for (const auto& [k, v] : api.getTimeMarkersRef()) {
+            LineColor color = v;
+            float x = k;
+            float lineWidth = 1.0f;
+
+            for (auto& fn : m_colorsForValue.flat) {
+                fn(color, x, lineWidth);
+            }
+            countCallbacks(m_colorsForValue.flat.size());
+
+            if (textureMode) {
+                uint32_t key;
+                std::memcpy(&key, &k, sizeof(key));
+                if (!m_markerTexture->setMarker(key, x, color.getColorA(), lineWidth)) {
+                    m_outsideTexture.push_back({x, color, lineWidth});
+                }
+                continue;
+            }
+
+            if (x < minX || x > maxX) continue;
+            if (aggregate) columns.drawLine(x, color, lineWidth);
+            else writer.drawLine({x, minY}, {x, maxY}, color, lineWidth);
+        }
+    }
 
-        for (auto& fn : m_colorsForValue.flat) {
-            fn(color, x, lineWidth);
+    if (textureMode) {
+        for (const auto& line : m_outsideTexture) {
+            if (line.m_x < minX || line.m_x > maxX) continue;
+            if (aggregate) columns.drawLine(line.m_x, line.m_color, line.m_width);
+            else writer.drawLine({line.m_x, minY}, {line.m_x, maxY}, line.m_color, line.m_width);
         }
+    }
+    if (aggregate) columns.flush(minY, maxY);
 
-        if (x < minX || x > maxX) continue;
-        api.drawLine({x, minY}, {x, maxY}, color, lineWidth);
+    if (textureMode) {
+        if (fillTexture) m_markerTexture->endUpdate();
+        drawMarkerTexture(api, m_markerTexture, minX, maxX, minY, maxY);
     }
 }
 
+void Guidelines::setTextureMode(bool enabled) {
+    m_textureMode = enabled;
+    if (!enabled) m_markerTexture = nullptr;
+    setRenderThreadOnly(enabled || !m_colorsForValue.empty());
+    setAlwaysLive(enabled || !m_colorsForValue.empty());
+}
+
+bool Guidelines::isTextureMode() const {
+    return m_textureMode;
+}
+
 void Guidelines::setPropertiesForValue(GuidelineCallback colorForValue, int priority) {
     m_colorsForValue.add(std::move(colorForValue), priority);
+    setRenderThreadOnly(true);
+    setAlwaysLive(true);
+}
+
+static float audioLineSpeed(DrawGridLayer* dgl, AudioLineGuideGameObject* obj) {
+    switch (obj->m_speed) {
+        case Speed::Slow:    return dgl->m_slowSpeed;
+        case Speed::Fast:    return dgl->m_fastSpeed;
+        case Speed::Faster:  return dgl->m_fasterSpeed;
+        case Speed::Fastest: return dgl->m_fastestSpeed;
+        default:             return dgl->m_normalSpeed;
+    }
 }
 
 void BPMTriggers::draw(DrawGridLayer* dgl, float minX, float maxX, float minY, float maxY) {
@@ -464,17 +710,13 @@ void BPMTriggers::draw(DrawGridLayer* dgl, float minX, float maxX, float minY, f
 
     m_colorsForBeats.rebuildIfNeeded();
 
+    auto writer = api.getLineWriter<DrawGridAPI::DrawMode::NORMAL>(1.0f);
+    const bool aggregate = api.getColumnAggregation() != DrawGridAPI::ColumnAggregation::OFF;
+    DrawGridAPI::ColumnAggregator columns(api);
+
     for (auto& [_, obj] : dgl->m_audioLineObjects) {
         if (obj->m_disabled || !api.isObjectVisible(obj)) continue;
-        float speed = dgl->m_normalSpeed;
-        
-        switch (obj->m_speed) {
-            case Speed::Slow:    speed = dgl->m_slowSpeed;    break;
-            case Speed::Fast:    speed = dgl->m_fastSpeed;    break;
-            case Speed::Faster:  speed = dgl->m_fasterSpeed;  break;
-            case Speed::Fastest: speed = dgl->m_fastestSpeed; break;
-            default: break;
-        }
+        const float speed = audioLineSpeed(dgl, obj);
         const float startX = obj->getPositionX();
         const float duration = obj->m_duration * speed;
         const float endX = startX + duration;
@@ -485,13 +727,32 @@ void BPMTriggers::draw(DrawGridLayer* dgl, float minX, float maxX, float minY, f
        
         int beatStart = std::max(0, static_cast<int>(std::floor((minX - startX) / timeStep)));
         int beatEnd = static_cast<int>(std::ceil((maxX - startX) / timeStep));
+
+        static const auto defaultLineColorA = LineColor{255, 255, 0, 255};
+        static const auto defaultLineColorB = LineColor{255, 127, 0, 255};
+
+        // beats closer than a pixel go through the aggregator instead
+        const bool aggregateBeats = aggregate && timeStep * columns.getPixelsPerUnit() < 1;
+
+        // without callbacks every beat is a plain evenly spaced line, so the whole visible run can go out at once
+        if (m_colorsForBeats.flat.empty() && timeStep > 0 && !aggregateBeats) {
+            const float limitX = std::min(maxX, endX);
+            auto beatX = [&](int beat) { return startX + timeStep * beat; };
+
+            int first = beatStart;
+            while (first <= beatEnd && beatX(first) < minX) ++first;
+
+            int last = std::min(beatEnd, static_cast<int>(std::floor((limitX - startX) / timeStep)));
+            while (last >= first && beatX(last) > limitX) --last;
+            while (last < beatEnd && beatX(last + 1) <= limitX) ++last;
+
+            api.drawVerticalLines(startX, timeStep, first, last, minY, maxY, defaultLineColorB, 1.0f, DrawGridAPI::DrawMode::NORMAL, beatsPerBar, defaultLineColorA);
+            continue;
+        }
         
         for (int beat = beatStart; beat <= beatEnd; ++beat) {
             float x = startX + timeStep * beat;
 
-            static const auto defaultLineColorA = LineColor{255, 255, 0, 255};
-            static const auto defaultLineColorB = LineColor{255, 127, 0, 255};
-
             LineColor color;
             float lineWidth = 1.0f;
             if (beat % beatsPerBar == 0) {
@@ -504,17 +765,21 @@ void BPMTriggers::draw(DrawGridLayer* dgl, float minX, float maxX, float minY, f
             for (auto& fn : m_colorsForBeats.flat) {
                 fn(color, obj, x, beat, beatsPerBar, lineWidth);
             }
+            countCallbacks(m_colorsForBeats.flat.size());
 
             if (x < minX || x > maxX) continue;
             if (x > endX || beat > beatEnd) break;
 
-            api.drawLine({x, minY}, {x, maxY}, color, lineWidth);
+            if (aggregateBeats) columns.drawLine(x, color, lineWidth);
+            else writer.drawLine({x, minY}, {x, maxY}, color, lineWidth);
         }
     }
+    if (aggregate) columns.flush(minY, maxY);
 }
 
 void BPMTriggers::setPropertiesForBeats(BPMTriggerCallback colorForBeats, int priority) {
     m_colorsForBeats.add(std::move(colorForBeats), priority);
+    setRenderThreadOnly(true);
 }
 
 void AudioLine::draw(DrawGridLayer* dgl, float minX, float maxX, float minY, float maxY) {
@@ -568,6 +833,7 @@ void AudioLine::draw(DrawGridLayer* dgl, float minX, float maxX, float minY, flo
     for (auto& fn : m_colorsForTime.flat) {
         fn(color, playbackActive, playbackTime, {playbackX, playbackY}, width);
     }
+    countCallbacks(m_colorsForTime.flat.size());
 
     if (playbackX != 0) {
         api.drawLine({playbackX, minY}, {playbackX, maxY}, color, width);
@@ -729,4 +995,299 @@ int PreviewLockLine::getLineWidthPriority() const {
 
 float PreviewLockLine::getLineWidth() const {
     return m_lineWidth;
-}
\ No newline at end of file
+}
+
+// objects looked at per array each frame once the first full pass is done
+static constexpr size_t OVERVIEW_SCAN_BUDGET = 2048;
+static constexpr float OVERVIEW_MARGIN = 8.f;
+
+void LevelOverview::init(DrawGridLayer* dgl) {
+    setShown(Mod::get()->getSettingValue<bool>("level-overview"));
+}
+
+void LevelOverview::addSpan(Track& track, float x, float endX, float weight) {
+    auto add = [&track](size_t column, float amount) {
+        float& value = track.m_columns[column];
+        // removing a span can leave a little float error behind
+        value = std::max(0.f, value + amount);
+    };
+
+    const size_t first = std::min(static_cast<size_t>(x / m_columnWidth), COLUMNS - 1);
+    if (endX <= x) {
+        add(first, weight);
+        return;
+    }
+    const size_t last = std::min(static_cast<size_t>(endX / m_columnWidth), COLUMNS - 1);
+    const float perUnit = weight / (endX - x);
+    for (size_t column = first; column <= last; ++column) {
+        const float from = std::max(x, column * m_columnWidth);
+        const float to = std::min(endX, (column + 1) * m_columnWidth);
+        if (to > from) add(column, (to - from) * perUnit);
+    }
+}
+
+// columns are merged in pairs so what's already binned stays exact
+void LevelOverview::grow(float x) {
+    while (x >= COLUMNS * m_columnWidth) {
+        for (Track* track : {&m_triggers, &m_durations, &m_beats}) {
+            auto& columns = track->m_columns;
+            for (size_t i = 0; i < COLUMNS / 2; ++i) {
+                columns[i] = columns[i * 2] + columns[i * 2 + 1];
+            }
+            std::fill(columns.begin() + COLUMNS / 2, columns.end(), 0.f);
+        }
+        m_columnWidth *= 2;
+    }
+}
+
+void LevelOverview::visit(Track& track, const void* key, float x, float endX, float weight) {
+    if (!std::isfinite(x) || !std::isfinite(endX) || !std::isfinite(weight)) return;
+    x = std::max(x, 0.f);
+    endX = std::max(endX, x);
+
+    auto [it, inserted] = track.m_records.try_emplace(key);
+    Record& record = it->second;
+    if (!inserted) {
+        if (record.m_x == x && record.m_endX == endX && record.m_weight == weight) {
+            record.m_sweep = track.m_sweep;
+            return;
+        }
+        addSpan(track, record.m_x, record.m_endX, -record.m_weight);
+    }
+    grow(endX);
+    record = {x, endX, weight, track.m_sweep};
+    addSpan(track, x, endX, weight);
+}
+
+// whatever wasn't seen since the last sweep has been deleted
+void LevelOverview::endSweep(Track& track) {
+    for (auto it = track.m_records.begin(); it != track.m_records.end();) {
+        if (it->second.m_sweep != track.m_sweep) {
+            addSpan(track, it->second.m_x, it->second.m_endX, -it->second.m_weight);
+            it = track.m_records.erase(it);
+        }
+        else ++it;
+    }
+    ++track.m_sweep;
+}
+
+/*
+    Nothing tells the overview when an object changes, so each frame looks at the next few rows of the trigger
+    tables and updates the ones that moved. A full pass takes a frame per OVERVIEW_SCAN_BUDGET rows, so on huge
+    levels a change only shows up once the pass gets to it, after the trigger table has picked it up.
+*/
+void LevelOverview::update(DrawGridLayer* dgl) {
+    auto scan = [this](Track& track, const TriggerTable& table, auto&& visitRow) {
+        const size_t count = table.size();
+        if (track.m_cursor >= count) {
+            track.m_cursor = 0;
+            endSweep(track);
+        }
+        const bool firstPass = track.m_sweep == 1 && track.m_cursor == 0;
+        const size_t budget = firstPass ? count : std::min(count, OVERVIEW_SCAN_BUDGET);
+        for (size_t i = 0; i < budget; ++i) {
+            visitRow(track.m_cursor++);
+            if (track.m_cursor >= count) {
+                track.m_cursor = 0;
+                endSweep(track);
+            }
+        }
+    };
+
+    auto& api = DrawGridAPI::get();
+    const TriggerTable& triggers = api.getEffectTriggers();
+    scan(m_triggers, triggers, [&](size_t row) {
+        if (triggers.flags[row] & (TriggerTable::SPAWN_TRIGGERED | TriggerTable::TOUCH_TRIGGERED)) return;
+        const float x = triggers.x[row];
+        visit(m_triggers, triggers.objects[row], x, x, 1.f);
+    });
+
+    // the end is only known once DurationLines has worked it out, until then it's guessed at normal speed
+    const TriggerTable& durations = api.getDurationTriggers();
+    scan(m_durations, durations, [&](size_t row) {
+        const float time = durations.durations[row];
+        if (time <= 0) return;
+        const float x = durations.x[row];
+        const float endPositionX = static_cast<EffectGameObject*>(durations.objects[row])->m_endPosition.x;
+        const float endX = endPositionX > x ? endPositionX : x + time * 311.5801f;
+        visit(m_durations, durations.objects[row], x, endX, endX - x);
+    });
+
+    for (auto& [_, obj] : dgl->m_audioLineObjects) {
+        if (obj->m_disabled || obj->m_beatsPerMinute == 0 || obj->m_beatsPerBar == 0) continue;
+        const float speed = audioLineSpeed(dgl, obj);
+        const float startX = obj->getPositionX();
+        const float duration = obj->m_duration * speed;
+        const float timeStep = speed * 60.f / (obj->m_beatsPerMinute * obj->m_beatsPerBar);
+        if (timeStep <= 0) continue;
+        visit(m_beats, obj, startX, startX + duration, duration / timeStep);
+    }
+    endSweep(m_beats);
+}
+
+void LevelOverview::draw(DrawGridLayer* dgl, float minX, float maxX, float minY, float maxY) {
+    if (!m_shown || dgl->m_editorLayer->m_playbackMode == PlaybackMode::Playing) return;
+
+    update(dgl);
+
+    auto& api = DrawGridAPI::get();
+    const ViewPolygon& view = api.getViewPolygon();
+    const float scale = api.getViewScale();
+    const CCSize winSize = CCDirector::get()->getWinSize();
+    const float pixelsPerPoint = CCDirector::get()->getWinSizeInPixels().width / winSize.width;
+
+    // the strip is laid out in screen points and turned with the view, so it stays put while panning and rotating
+    const CCPoint origin = view.corners[0];
+    const CCPoint alongX = view.corners[1] - origin;
+    const CCPoint alongY = view.corners[3] - origin;
+    const float viewWidth = alongX.getLength() * scale;
+    const CCPoint unitX = alongX / (alongX.getLength() * scale);
+    const CCPoint unitY = alongY / (alongY.getLength() * scale);
+    auto toLevel = [&](float u, float v) -> ccVertex2F {
+        const CCPoint point = origin + unitX * u + unitY * v;
+        return {point.x, point.y};
+    };
+
+    const float left = OVERVIEW_MARGIN;
+    const float right = viewWidth - OVERVIEW_MARGIN;
+    const float bottom = OVERVIEW_MARGIN + (api.isMainContext() ? dgl->m_editorLayer->m_editorUI->m_toolbarHeight : 0.f);
+    const float top = bottom + m_height;
+    if (right <= left) return;
+
+    size_t usedColumns = 0;
+    for (const Track* track : {&m_triggers, &m_durations, &m_beats}) {
+        for (size_t column = COLUMNS; column > usedColumns; --column) {
+            if (track->m_columns[column - 1] > 0) {
+                usedColumns = column;
+                break;
+            }
+        }
+    }
+    const float levelEnd = std::max({usedColumns * m_columnWidth, maxX, m_columnWidth});
+    const float columnsShown = levelEnd / m_columnWidth;
+
+    auto writer = api.getLineWriter<DrawGridAPI::DrawMode::NORMAL>(1.0f);
+    const int pixels = static_cast<int>((right - left) * pixelsPerPoint);
+    const float bandHeight = m_height / 3.f;
+    const Track* tracks[] = {&m_beats, &m_durations, &m_triggers};
+    const LineColor* colors[] = {&m_beatColor, &m_durationColor, &m_triggerColor};
+
+    for (size_t band = 0; band < 3; ++band) {
+        const auto& columns = tracks[band]->m_columns;
+        const float peak = *std::max_element(columns.begin(), columns.begin() + std::max<size_t>(usedColumns, 1));
+        if (peak <= 0) continue;
+        // log scaled so a few dense spots don't flatten everything else
+        const float normalize = 1.f / std::log1p(peak);
+        const float bandBottom = bottom + bandHeight * band;
+        const LineColor color = colors[band]->getColorA();
+
+        for (int pixel = 0; pixel < pixels; ++pixel) {
+            const size_t first = static_cast<size_t>(pixel * columnsShown / pixels);
+            const size_t last = std::max(first + 1, static_cast<size_t>((pixel + 1) * columnsShown / pixels));
+            float value = 0;
+            for (size_t column = first; column < last && column < COLUMNS; ++column) {
+                value = std::max(value, columns[column]);
+            }
+            if (value <= 0) continue;
+
+            const float u = left + (pixel + 0.5f) / pixelsPerPoint;
+            const float height = bandHeight * std::log1p(value) * normalize;
+            writer.drawLine(toLevel(u, bandBottom), toLevel(u, bandBottom + height), color, 1.0f);
+        }
+    }
+
+    static const auto frameColor = LineColor{255, 255, 255, 60};
+    static const auto rangeColor = LineColor{255, 255, 255, 200};
+    writer.drawLine(toLevel(left, bottom), toLevel(right, bottom), frameColor, 1.0f);
+    writer.drawLine(toLevel(left, top), toLevel(right, top), frameColor, 1.0f);
+
+    // what's on screen right now
+    for (float x : {std::max(minX, 0.f), maxX}) {
+        const float u = left + (right - left) * std::clamp(x / levelEnd, 0.f, 1.f);
+        writer.drawLine(toLevel(u, bottom), toLevel(u, top), rangeColor, 1.0f);
+    }
+}
+
+void LevelOverview::setShown(bool shown) {
+    m_shown = shown;
+}
+
+bool LevelOverview::isShown() const {
+    return m_shown;
+}
+
+void LevelOverview::setTriggerColor(const LineColor& color, int priority) {
+    if (priority >= m_triggerColorPriority) {
+        m_triggerColor = color;
+        m_triggerColorPriority = priority;
+    }
+}
+
+void LevelOverview::setDurationColor(const LineColor& color, int priority) {
+    if (priority >= m_durationColorPriority) {
+        m_durationColor = color;
+        m_durationColorPriority = priority;
+    }
+}
+
+void LevelOverview::setBeatColor(const LineColor& color, int priority) {
+    if (priority >= m_beatColorPriority) {
+        m_beatColor = color;
+        m_beatColorPriority = priority;
+    }
+}
+
+void LevelOverview::setHeight(float height, int priority) {
+    if (priority >= m_heightPriority) {
+        m_height = height;
+        m_heightPriority = priority;
+    }
+}
+
+int LevelOverview::getTriggerColorPriority() const {
+    return m_triggerColorPriority;
+}
+
+int LevelOverview::getDurationColorPriority() const {
+    return m_durationColorPriority;
+}
+
+int LevelOverview::getBeatColorPriority() const {
+    return m_beatColorPriority;
+}
+
+int LevelOverview::getHeightPriority() const {
+    return m_heightPriority;
+}
+
+const LineColor& LevelOverview::getTriggerColor() const {
+    return m_triggerColor;
+}
+
+const LineColor& LevelOverview::getDurationColor() const {
+    return m_durationColor;
+}
+
+const LineColor& LevelOverview::getBeatColor() const {
+    return m_beatColor;
+}
+
+float LevelOverview::getHeight() const {
+    return m_height;
+}
+
+float LevelOverview::getColumnWidth() const {
+    return m_columnWidth;
+}
+
+const std::array<float, LevelOverview::COLUMNS>& LevelOverview::getTriggerDensity() const {
+    return m_triggers.m_columns;
+}
+
+const std::array<float, LevelOverview::COLUMNS>& LevelOverview::getDurationDensity() const {
+    return m_durations.m_columns;
+}
+
+const std::array<float, LevelOverview::COLUMNS>& LevelOverview::getBeatDensity() const {
+    return m_beats.m_columns;
+}
@@ -4,6 +4,14 @@ struct DrawNodeImpl {
     std::string m_id;
     int m_zOrder = 0;
     bool m_enabled = true;
+    bool m_threadSafe = false;
+    bool m_renderThreadOnly = false;
+    bool m_cacheable = false;
+    bool m_alwaysLive = false;
+    DrawGridAPI* m_api = nullptr;
+    size_t m_callbackCount = 0;
+    float m_cullingMargin = 0;
+    int m_budgetPriority = 0;
 };
 
 DrawNode::DrawNode() : m_impl(std::make_unique<DrawNodeImpl>()) {}
@@ -29,6 +37,10 @@ std::string DrawNode::getID() const {
     return m_impl->m_id;
 }
 
+const std::string& DrawNode::getIDRef() const {
+    return m_impl->m_id;
+}
+
 bool DrawNode::isEnabled() const {
     return m_impl->m_enabled;
 }
@@ -43,11 +55,66 @@ int DrawNode::getZOrder() const {
 
 void DrawNode::setZOrder(int order) {
     m_impl->m_zOrder = order;
-    DrawGridAPI::get().shouldSort();
+    if (m_impl->m_api) m_impl->m_api->shouldSort();
 }
 
 void DrawNode::setID(const std::string& id) {
+    if (m_impl->m_id == id) return;
+    const std::string oldID = m_impl->m_id;
     m_impl->m_id = id;
+    if (m_impl->m_api) m_impl->m_api->renameNode(this, oldID);
+}
+
+void DrawNode::setAPI(DrawGridAPI* api) {
+    m_impl->m_api = api;
+}
+
+void DrawNode::setThreadSafe(bool threadSafe) {
+    m_impl->m_threadSafe = threadSafe;
+}
+
+bool DrawNode::isThreadSafe() const {
+    return m_impl->m_threadSafe && !m_impl->m_renderThreadOnly;
+}
+
+void DrawNode::setRenderThreadOnly(bool renderThreadOnly) {
+    m_impl->m_renderThreadOnly = renderThreadOnly;
+}
+
+void DrawNode::setCacheable(bool cacheable) {
+    m_impl->m_cacheable = cacheable;
+}
+
+bool DrawNode::isCacheable() const {
+    return m_impl->m_cacheable && !m_impl->m_alwaysLive;
+}
+
+void DrawNode::setAlwaysLive(bool alwaysLive) {
+    m_impl->m_alwaysLive = alwaysLive;
+}
+
+void DrawNode::setCullingMargin(float margin) {
+    m_impl->m_cullingMargin = std::max(margin, 0.f);
+}
+
+float DrawNode::getCullingMargin() const {
+    return m_impl->m_cullingMargin;
+}
+
+void DrawNode::setBudgetPriority(int priority) {
+    m_impl->m_budgetPriority = priority;
+}
+
+int DrawNode::getBudgetPriority() const {
+    return m_impl->m_budgetPriority;
+}
+
+size_t DrawNode::getCallbackCount() const {
+    return m_impl->m_callbackCount;
+}
+
+void DrawNode::countCallbacks(size_t count) {
+    m_impl->m_callbackCount += count;
 }
 
 void DrawNode::draw(DrawGridLayer* dgl, float minX, float maxX, float minY, float maxY) {}
@@ -2,9 +2,98 @@
 #include <Geode/modify/EditorUI.hpp>
 #include "../include/DrawGridAPI.hpp"
 
+using namespace geode::prelude;
+
 class $modify(MyEditorUI, EditorUI) {
+
+	struct Fields {
+		CCLabelBMFont* m_profilerLabel = nullptr;
+		// only profiling the overlay turned on gets turned off again, someone else may have wanted it
+		bool m_startedProfiling = false;
+
+		~Fields() {
+			if (m_startedProfiling) DrawGridAPI::get().setProfiling(false);
+		}
+	};
+
+	bool init(LevelEditorLayer* editorLayer) {
+		if (!EditorUI::init(editorLayer)) return false;
+
+		auto label = CCLabelBMFont::create("", "chatFont.fnt");
+		label->setAnchorPoint({0, 1});
+		label->setScale(0.4f);
+		label->setPosition({5, CCDirector::get()->getWinSize().height - 5});
+		label->setVisible(false);
+		addChild(label, 100);
+		m_fields->m_profilerLabel = label;
+
+		schedule(schedule_selector(MyEditorUI::updateProfilerOverlay), 0.25f);
+		return true;
+	}
+
+	void updateProfilerOverlay(float dt) {
+		auto label = m_fields->m_profilerLabel;
+		auto& api = DrawGridAPI::get();
+
+		bool show = Mod::get()->getSettingValue<bool>("profiler-overlay");
+		label->setVisible(show);
+		if (!show) {
+			if (m_fields->m_startedProfiling) api.setProfiling(false);
+			m_fields->m_startedProfiling = false;
+			return;
+		}
+		if (!api.isProfiling()) {
+			api.setProfiling(true);
+			m_fields->m_startedProfiling = true;
+		}
+
+		const auto summary = api.getProfilerSummary();
+		std::string text = fmt::format("frame {:.2f}ms avg, {:.2f}ms p99, {:.0f} draw calls, {:.0f} vertices\n", summary.averageFrameMs, summary.p99FrameMs, summary.averageDrawCalls, summary.averageVertices);
+		if (const size_t allocations = api.getDrawLoopAllocations()) {
+			text += fmt::format("{} heap allocations while drawing\n", allocations);
+		}
+		if (api.isGeometryOptimization()) {
+			const auto geometry = api.getGeometryStats();
+			text += fmt::format("{} primitives optimized out ({} transparent, {} duplicates, {} merged)\n", geometry.total(), geometry.transparent, geometry.duplicates, geometry.merged);
+		}
+		if (api.isStaticCache()) {
+			const auto cache = api.getStaticCacheStats();
+			text += fmt::format("static cache {} hits, {} redraws\n", cache.hits, cache.renders);
+		}
+		for (const auto& node : api.getDegradedNodes()) {
+			text += fmt::format("{} drawn every {} frames over budget\n", node.id, node.interval);
+		}
+		if (summary.averageGPUMs >= 0) {
+			text += fmt::format("gpu {:.2f}ms avg, {:.2f}ms p99\n", summary.averageGPUMs, summary.p99GPUMs);
+		}
+		for (const auto& node : summary.nodes) {
+			text += fmt::format("{}: {:.3f}ms avg, {:.3f}ms p99, {:.0f} primitives, {:.0f} callbacks\n", node.id, node.averageMs, node.p99Ms, node.averagePrimitives, node.averageCallbacks);
+		}
+		label->setString(text.c_str());
+	}
+
 	void updateZoom(float p0) {
 		EditorUI::updateZoom(p0);
 		DrawGridAPI::get().markDirty();
 	}
-};
\ No newline at end of file
+
+	void moveObject(GameObject* p0, CCPoint p1) {
+		EditorUI::moveObject(p0, p1);
+		DrawGridAPI::get().updateTrigger(p0);
+	}
+
+	void transformObject(GameObject* p0, EditCommand p1, bool p2) {
+		EditorUI::transformObject(p0, p1, p2);
+		DrawGridAPI::get().updateTrigger(p0);
+	}
+
+	void undoLastAction(CCObject* p0) {
+		EditorUI::undoLastAction(p0);
+		DrawGridAPI::get().invalidateTriggerTables();
+	}
+
+	void redoLastAction(CCObject* p0) {
+		EditorUI::redoLastAction(p0);
+		DrawGridAPI::get().invalidateTriggerTables();
+	}
+};
@@ -0,0 +1,124 @@
+#include "../include/DrawGridAPI.hpp"
+#include "DrawGridAPIImpl.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <Geode/Geode.hpp>
+
+using namespace geode::prelude;
+
+void* FrameArena::allocate(size_t bytes, size_t alignment) {
+    while (m_block < m_blocks.size()) {
+        auto& block = m_blocks[m_block];
+        const auto base = reinterpret_cast<uintptr_t>(block.m_data.get());
+        const uintptr_t aligned = (base + m_offset + alignment - 1) & ~(alignment - 1);
+        if (aligned + bytes <= base + block.m_size) {
+            m_offset = aligned + bytes - base;
+            m_used += bytes;
+            return reinterpret_cast<void*>(aligned);
+        }
+        ++m_block;
+        m_offset = 0;
+    }
+
+    auto& block = m_blocks.emplace_back();
+    block.m_size = std::max(BLOCK_SIZE, bytes + alignment);
+    block.m_data = std::make_unique<std::byte[]>(block.m_size);
+    m_block = m_blocks.size() - 1;
+    m_offset = 0;
+    return allocate(bytes, alignment);
+}
+
+void FrameArena::reset() {
+    if (m_blocks.size() > 1) {
+        const size_t size = getReservedBytes();
+        m_blocks.clear();
+        auto& block = m_blocks.emplace_back();
+        block.m_size = size;
+        block.m_data = std::make_unique<std::byte[]>(size);
+    }
+    m_block = 0;
+    m_offset = 0;
+    m_used = 0;
+}
+
+size_t FrameArena::getUsedBytes() const {
+    return m_used;
+}
+
+size_t FrameArena::getReservedBytes() const {
+    size_t bytes = 0;
+    for (const auto& block : m_blocks) bytes += block.m_size;
+    return bytes;
+}
+
+FrameArena& DrawGridAPI::getFrameArena() {
+    return m_impl->targetBuffers().m_arena;
+}
+
+/*
+    Debug builds with GOOD_GRID_COUNT_DRAW_ALLOCATIONS replace this module's operator new to count what
+    nodes still allocate from the heap while drawing. Other mods have their own, so their callbacks only
+    show up if they allocate through Good Grid.
+*/
+#ifdef GOOD_GRID_COUNT_DRAW_ALLOCATIONS
+
+static std::atomic<size_t> s_drawLoopAllocations = 0;
+static thread_local bool t_inDrawLoop = false;
+
+DrawLoopAllocationScope::DrawLoopAllocationScope() : m_previous(t_inDrawLoop) {
+    t_inDrawLoop = true;
+}
+
+DrawLoopAllocationScope::~DrawLoopAllocationScope() {
+    t_inDrawLoop = m_previous;
+}
+
+size_t takeDrawLoopAllocations() {
+    return s_drawLoopAllocations.exchange(0, std::memory_order_relaxed);
+}
+
+static void* countedAllocate(size_t size) {
+    if (t_inDrawLoop) s_drawLoopAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size) {
+    return countedAllocate(size);
+}
+
+void* operator new[](size_t size) {
+    return countedAllocate(size);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+#else
+
+DrawLoopAllocationScope::DrawLoopAllocationScope() : m_previous(false) {}
+DrawLoopAllocationScope::~DrawLoopAllocationScope() {}
+
+size_t takeDrawLoopAllocations() {
+    return 0;
+}
+
+#endif
+
+size_t DrawGridAPI::getDrawLoopAllocations() {
+    return m_impl->m_drawLoopAllocations;
+}
@@ -0,0 +1,192 @@
+#include "../include/DrawGridAPI.hpp"
+#include "DrawGridAPIImpl.hpp"
+#include <utility>
+#include <Geode/Geode.hpp>
+
+using namespace geode::prelude;
+
+// a degraded node is drawn every 2, 4 or 8 frames
+static constexpr int MAX_LEVEL = 3;
+// nodes cheaper than this per frame aren't worth degrading
+static constexpr float MIN_COST_MS = 0.05f;
+static constexpr int DEGRADE_AFTER_FRAMES = 30;
+static constexpr int RECOVER_AFTER_FRAMES = 120;
+// a node is only brought back while the frame stays under this much of the budget with it
+static constexpr float RECOVER_FRACTION = 0.75f;
+
+static float amortizedCost(const ScheduledNode& node) {
+    return node.m_costMs / (1 << node.m_level);
+}
+
+void drawDegradedNodes(DrawGridAPIImpl& impl, const ViewCamera& camera) {
+    auto& scheduler = impl.m_scheduler;
+    if (scheduler.m_budgetMs <= 0) return;
+
+    const uint64_t frame = impl.m_frameNumber.load(std::memory_order_relaxed);
+    ViewCamera grown = camera;
+    grown.m_size = {camera.m_size.width * 2, camera.m_size.height * 2};
+    ViewPolygon polygon;
+    CCRect bounds;
+    bool computed = false;
+
+    for (size_t i = 0; i < impl.m_drawNodes.size(); ++i) {
+        const DrawNode& drawNode = *impl.m_drawNodes[i];
+        auto& node = scheduler.m_nodes[&drawNode];
+        if (!drawNode.isEnabled() || node.m_level == 0 || drawnFromStaticCache(impl, drawNode)) {
+            node.m_hasGeometry = false;
+            continue;
+        }
+
+        const bool due = !node.m_hasGeometry
+            || frame - node.m_drawnFrame >= (1u << node.m_level)
+            || node.m_camera.m_scale != camera.m_scale
+            || node.m_camera.m_angle != camera.m_angle
+            || !viewContains(node.m_camera, camera);
+        if (!due) continue;
+
+        if (!computed) {
+            polygon = computeViewPolygon(grown);
+            bounds = viewBounds(impl, polygon);
+            computed = true;
+        }
+
+        // drawn for twice the view so the geometry still covers it after some panning
+        const ViewPolygon framePolygon = std::exchange(impl.m_viewPolygon, polygon);
+        const CCRect frameRect = std::exchange(impl.m_visibleRect, bounds);
+        node.m_geometry.reset();
+        {
+            TargetBuffersScope scope(&node.m_geometry);
+            drawNodeProfiled(impl, i, node.m_geometry, bounds.getMinX(), bounds.getMaxX(), bounds.getMinY(), bounds.getMaxY());
+        }
+        impl.m_viewPolygon = framePolygon;
+        impl.m_visibleRect = frameRect;
+
+        node.m_hasGeometry = true;
+        node.m_drawnFrame = frame;
+        node.m_camera = grown;
+    }
+}
+
+bool reuseDegradedGeometry(DrawGridAPIImpl& impl, const DrawNode& drawNode, VertexBuffers& buffers) {
+    if (impl.m_scheduler.m_budgetMs <= 0) return false;
+
+    auto it = impl.m_scheduler.m_nodes.find(&drawNode);
+    if (it == impl.m_scheduler.m_nodes.end() || it->second.m_level == 0 || !it->second.m_hasGeometry) return false;
+    buffers.append(it->second.m_geometry);
+    return true;
+}
+
+void recordNodeCost(DrawGridAPIImpl& impl, const DrawNode& drawNode, float ms, bool queuedCustomDraws) {
+    auto it = impl.m_scheduler.m_nodes.find(&drawNode);
+    if (it == impl.m_scheduler.m_nodes.end()) return;
+
+    auto& node = it->second;
+    node.m_costMs = node.m_costMs == 0 ? ms : node.m_costMs + (ms - node.m_costMs) * 0.2f;
+    if (queuedCustomDraws) {
+        node.m_reusable = false;
+        node.m_level = 0;
+    }
+}
+
+// the least important node that still costs something is drawn half as often
+static void degradeNode(DrawGridAPIImpl& impl) {
+    ScheduledNode* chosen = nullptr;
+    int chosenPriority = 0;
+
+    for (const auto& drawNode : impl.m_drawNodes) {
+        auto& node = impl.m_scheduler.m_nodes[drawNode.get()];
+        if (!drawNode->isEnabled() || !node.m_reusable || node.m_level >= MAX_LEVEL || drawnFromStaticCache(impl, *drawNode)) continue;
+        if (amortizedCost(node) < MIN_COST_MS) continue;
+
+        const int priority = drawNode->getBudgetPriority();
+        if (!chosen || priority < chosenPriority || (priority == chosenPriority && amortizedCost(node) > amortizedCost(*chosen))) {
+            chosen = &node;
+            chosenPriority = priority;
+        }
+    }
+    if (chosen) ++chosen->m_level;
+}
+
+// the most important degraded node that fits in headroom is drawn twice as often
+static void recoverNode(DrawGridAPIImpl& impl, float headroomMs) {
+    ScheduledNode* chosen = nullptr;
+    int chosenPriority = 0;
+
+    for (const auto& drawNode : impl.m_drawNodes) {
+        auto& node = impl.m_scheduler.m_nodes[drawNode.get()];
+        if (node.m_level == 0) continue;
+        // going down a level draws it twice as often, adding its whole amortized cost again
+        if (amortizedCost(node) >= headroomMs) continue;
+
+        const int priority = drawNode->getBudgetPriority();
+        if (!chosen || priority > chosenPriority || (priority == chosenPriority && amortizedCost(node) < amortizedCost(*chosen))) {
+            chosen = &node;
+            chosenPriority = priority;
+        }
+    }
+    if (chosen) --chosen->m_level;
+}
+
+/*
+    Degrading waits for the frame to stay over budget for a while and recovering for it to stay well under,
+    and a node only comes back when what it would add still fits, so nodes don't flip back and forth.
+*/
+void updateScheduler(DrawGridAPIImpl& impl, float frameMs) {
+    auto& scheduler = impl.m_scheduler;
+    if (scheduler.m_budgetMs <= 0) return;
+
+    scheduler.m_smoothedMs = scheduler.m_smoothedMs == 0 ? frameMs : scheduler.m_smoothedMs + (frameMs - scheduler.m_smoothedMs) * 0.1f;
+    const float budget = scheduler.m_budgetMs;
+
+    if (scheduler.m_smoothedMs > budget) {
+        ++scheduler.m_overFrames;
+        scheduler.m_underFrames = 0;
+    }
+    else if (scheduler.m_smoothedMs < budget * RECOVER_FRACTION) {
+        ++scheduler.m_underFrames;
+        scheduler.m_overFrames = 0;
+    }
+    else {
+        scheduler.m_overFrames = 0;
+        scheduler.m_underFrames = 0;
+    }
+
+    if (scheduler.m_overFrames >= DEGRADE_AFTER_FRAMES) {
+        scheduler.m_overFrames = 0;
+        degradeNode(impl);
+    }
+    else if (scheduler.m_underFrames >= RECOVER_AFTER_FRAMES) {
+        scheduler.m_underFrames = 0;
+        recoverNode(impl, budget * RECOVER_FRACTION - scheduler.m_smoothedMs);
+    }
+}
+
+void DrawGridAPI::setFrameBudget(float ms) {
+    auto& scheduler = m_impl->m_scheduler;
+    scheduler.m_budgetMs = std::max(ms, 0.f);
+    if (scheduler.m_budgetMs > 0) return;
+
+    scheduler.m_smoothedMs = 0;
+    scheduler.m_overFrames = 0;
+    scheduler.m_underFrames = 0;
+    scheduler.m_nodes.clear();
+}
+
+float DrawGridAPI::getFrameBudget() {
+    return m_impl->m_scheduler.m_budgetMs;
+}
+
+int DrawGridAPI::getDegradation(const DrawNode& drawNode) {
+    auto it = m_impl->m_scheduler.m_nodes.find(&drawNode);
+    return it == m_impl->m_scheduler.m_nodes.end() ? 0 : it->second.m_level;
+}
+
+std::vector<DrawGridAPI::DegradedNode> DrawGridAPI::getDegradedNodes() {
+    std::vector<DegradedNode> degraded;
+    for (const auto& drawNode : m_impl->m_drawNodes) {
+        auto it = m_impl->m_scheduler.m_nodes.find(drawNode.get());
+        if (it == m_impl->m_scheduler.m_nodes.end() || it->second.m_level == 0) continue;
+        degraded.push_back({drawNode->getID(), it->second.m_level, 1 << it->second.m_level, it->second.m_costMs});
+    }
+    return degraded;
+}
@@ -0,0 +1,131 @@
+#include "../include/DrawGridAPI.hpp"
+#include "DrawGridAPIImpl.hpp"
+#include <cstdio>
+#include <Geode/Geode.hpp>
+
+using namespace geode::prelude;
+
+// GLES has no GL_TIME_ELAPSED, mobile builds just report timing as unsupported
+#ifdef GL_TIME_ELAPSED
+    #define GOOD_GRID_GPU_TIMERS
+#endif
+
+/*
+    The timers use the core entry points, glGetQueryObjectui64v included, which GL_EXT_timer_query alone
+    doesn't provide, so only contexts with the ARB extension or GL 3.3 count as supported.
+*/
+static bool checkSupport() {
+    #ifdef GOOD_GRID_GPU_TIMERS
+        if (CCConfiguration::sharedConfiguration()->checkForGLExtension("GL_ARB_timer_query")) return true;
+
+        int major = 0, minor = 0;
+        auto version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+        if (!version || std::sscanf(version, "%d.%d", &major, &minor) != 2) return false;
+        return major > 3 || (major == 3 && minor >= 3);
+    #else
+        return false;
+    #endif
+}
+
+static DrawGridAPI::ProfilerFrame* findRecordedFrame(ProfilerState& profiler, uint64_t frame) {
+    // the frame is only a few behind, so walk back from the newest
+    for (size_t i = 1; i <= profiler.m_size; ++i) {
+        auto& recorded = profiler.m_history[(profiler.m_next + PROFILER_HISTORY_SIZE - i) % PROFILER_HISTORY_SIZE];
+        if (recorded.frame == frame) return &recorded;
+        if (recorded.frame < frame) break;
+    }
+    return nullptr;
+}
+
+// returns false without touching anything if the GPU isn't done with the frame yet
+static bool collectResults(DrawGridAPIImpl& impl, GPUTimerFrame& timerFrame) {
+    #ifdef GOOD_GRID_GPU_TIMERS
+        for (size_t i = 0; i < timerFrame.m_used; ++i) {
+            GLint available = 0;
+            glGetQueryObjectiv(timerFrame.m_queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) return false;
+        }
+
+        auto recorded = findRecordedFrame(impl.m_profiler, timerFrame.m_frame);
+        if (recorded) recorded->gpuMs = 0;
+
+        for (size_t i = 0; i < timerFrame.m_used; ++i) {
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(timerFrame.m_queries[i], GL_QUERY_RESULT, &nanoseconds);
+            if (!recorded || i >= recorded->buckets.size()) continue;
+
+            const float ms = nanoseconds / 1'000'000.f;
+            recorded->buckets[i].gpuMs = ms;
+            recorded->gpuMs += ms;
+        }
+    #endif
+    timerFrame.m_pending = false;
+    return true;
+}
+
+void beginGPUTimerFrame(DrawGridAPIImpl& impl) {
+    auto& timers = impl.m_gpuTimers;
+    if (timers.m_supported == -1) timers.m_supported = checkSupport();
+    timers.m_active = timers.m_supported && impl.m_profiler.m_enabled;
+    if (!timers.m_active) return;
+
+    for (auto& timerFrame : timers.m_frames) {
+        if (timerFrame.m_pending) collectResults(impl, timerFrame);
+    }
+
+    const uint64_t frame = impl.m_frameNumber.load(std::memory_order_relaxed);
+    auto& current = timers.m_frames[frame % GPU_TIMER_LATENCY];
+    // still not done after a full round, drop it rather than stall
+    current.m_pending = false;
+    current.m_frame = frame;
+    current.m_used = 0;
+}
+
+void beginGPUTimer(DrawGridAPIImpl& impl) {
+    #ifdef GOOD_GRID_GPU_TIMERS
+        auto& timers = impl.m_gpuTimers;
+        auto& current = timers.m_frames[impl.m_frameNumber.load(std::memory_order_relaxed) % GPU_TIMER_LATENCY];
+        if (current.m_used == current.m_queries.size()) {
+            GLuint query;
+            glGenQueries(1, &query);
+            current.m_queries.push_back(query);
+        }
+        glBeginQuery(GL_TIME_ELAPSED, current.m_queries[current.m_used]);
+    #endif
+}
+
+void endGPUTimer(DrawGridAPIImpl& impl) {
+    #ifdef GOOD_GRID_GPU_TIMERS
+        auto& current = impl.m_gpuTimers.m_frames[impl.m_frameNumber.load(std::memory_order_relaxed) % GPU_TIMER_LATENCY];
+        glEndQuery(GL_TIME_ELAPSED);
+        ++current.m_used;
+        current.m_pending = true;
+    #endif
+}
+
+void resetGPUTimers(DrawGridAPIImpl& impl) {
+    auto& timers = impl.m_gpuTimers;
+    for (auto& timerFrame : timers.m_frames) {
+        #ifdef GOOD_GRID_GPU_TIMERS
+            if (!timerFrame.m_queries.empty()) glDeleteQueries(timerFrame.m_queries.size(), timerFrame.m_queries.data());
+        #endif
+        timerFrame = GPUTimerFrame{};
+    }
+    timers.m_supported = -1;
+    timers.m_active = false;
+}
+
+void DrawGridAPI::setGPUTiming(bool enabled) {
+    m_impl->m_gpuTimers.m_requested = enabled;
+    if (!enabled) m_impl->m_gpuTimers.m_active = false;
+}
+
+bool DrawGridAPI::isGPUTiming() {
+    return m_impl->m_gpuTimers.m_requested;
+}
+
+bool DrawGridAPI::isGPUTimingSupported() {
+    auto& timers = m_impl->m_gpuTimers;
+    if (timers.m_supported == -1) timers.m_supported = checkSupport();
+    return timers.m_supported;
+}
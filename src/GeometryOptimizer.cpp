@@ -0,0 +1,173 @@
+#include "../include/DrawGridAPI.hpp"
+#include "DrawGridAPIImpl.hpp"
+#include <bit>
+#include <cstring>
+#include <Geode/Geode.hpp>
+
+using namespace geode::prelude;
+
+static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+
+static uint32_t packColor(const ccColor4B& color) {
+    uint32_t packed;
+    std::memcpy(&packed, &color, sizeof(packed));
+    return packed;
+}
+
+static uint32_t floatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// zero in every channel adds nothing under any of the blend modes
+static bool isInvisible(const Vertex* vertices, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (packColor(vertices[i].color) != 0) return false;
+    }
+    return true;
+}
+
+static bool isOpaque(const Vertex* line) {
+    return line[0].color.a == 255 && line[1].color.a == 255;
+}
+
+static bool sameLine(const Vertex* a, const Vertex* b) {
+    for (size_t i = 0; i < 2; ++i) {
+        if (a[i].position.x != b[i].position.x || a[i].position.y != b[i].position.y) return false;
+        if (packColor(a[i].color) != packColor(b[i].color)) return false;
+    }
+    return true;
+}
+
+static size_t hashLine(const Vertex* line) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < 2; ++i) {
+        for (uint32_t value : {floatBits(line[i].position.x), floatBits(line[i].position.y), packColor(line[i].color)}) {
+            hash = (hash ^ value) * 0x100000001b3ull;
+        }
+    }
+    return static_cast<size_t>(hash ^ (hash >> 32));
+}
+
+// extends into onto the line after it when both are the same solid color and lie on the same axis line, overlapping or touching
+static bool mergeInto(Vertex* into, const Vertex* line) {
+    const uint32_t color = packColor(into[0].color);
+    if (packColor(into[1].color) != color || packColor(line[0].color) != color || packColor(line[1].color) != color) return false;
+
+    const bool vertical = into[0].position.x == into[1].position.x && line[0].position.x == line[1].position.x && into[0].position.x == line[0].position.x;
+    const bool horizontal = into[0].position.y == into[1].position.y && line[0].position.y == line[1].position.y && into[0].position.y == line[0].position.y;
+    if (vertical == horizontal) return false;
+
+    auto along = [vertical](const Vertex& vertex) { return vertical ? vertex.position.y : vertex.position.x; };
+    const float intoMin = std::min(along(into[0]), along(into[1]));
+    const float intoMax = std::max(along(into[0]), along(into[1]));
+    const float lineMin = std::min(along(line[0]), along(line[1]));
+    const float lineMax = std::max(along(line[0]), along(line[1]));
+    if (lineMin > intoMax || intoMin > lineMax) return false;
+
+    const float from = std::min(intoMin, lineMin);
+    const float to = std::max(intoMax, lineMax);
+    if (vertical) {
+        into[0].position.y = from;
+        into[1].position.y = to;
+    }
+    else {
+        into[0].position.x = from;
+        into[1].position.x = to;
+    }
+    return true;
+}
+
+/*
+    Opaque lines in the normal mode overwrite whatever is under them, so drawing one twice looks the same as
+    drawing it once. That's the only case where duplicates are dropped and lines are merged, blended and
+    inverted lines build up with every copy. Of identical lines only the last is kept, since it's the one
+    that ends up on top, and lines are only merged into the one drawn right before them so nothing can get
+    drawn between the two.
+*/
+static void optimizeLines(FrameArena& arena, std::vector<Vertex>& vertices, bool overwrites, DrawGridAPI::GeometryStats& stats) {
+    const size_t lines = vertices.size() / 2;
+    if (lines == 0) return;
+
+    FrameVector<uint8_t> duplicate{FrameAllocator<uint8_t>(arena)};
+    if (overwrites && lines > 1) {
+        duplicate.assign(lines, 0);
+        const size_t capacity = std::bit_ceil(lines * 2);
+        FrameVector<uint32_t> table(capacity, EMPTY_SLOT, FrameAllocator<uint32_t>(arena));
+
+        for (size_t i = lines; i-- > 0;) {
+            const Vertex* line = &vertices[i * 2];
+            if (!isOpaque(line)) continue;
+
+            size_t slot = hashLine(line) & (capacity - 1);
+            while (table[slot] != EMPTY_SLOT && !sameLine(&vertices[table[slot] * 2], line)) {
+                slot = (slot + 1) & (capacity - 1);
+            }
+            if (table[slot] == EMPTY_SLOT) table[slot] = static_cast<uint32_t>(i);
+            else duplicate[i] = 1;
+        }
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < lines; ++i) {
+        const Vertex line[2] = {vertices[i * 2], vertices[i * 2 + 1]};
+        if (isInvisible(line, 2)) {
+            ++stats.transparent;
+            continue;
+        }
+        if (!duplicate.empty() && duplicate[i]) {
+            ++stats.duplicates;
+            continue;
+        }
+        if (overwrites && kept > 0 && isOpaque(line) && isOpaque(&vertices[kept - 2]) && mergeInto(&vertices[kept - 2], line)) {
+            ++stats.merged;
+            continue;
+        }
+        vertices[kept++] = line[0];
+        vertices[kept++] = line[1];
+    }
+    vertices.resize(kept);
+}
+
+static void dropInvisible(std::vector<Vertex>& vertices, size_t stride, DrawGridAPI::GeometryStats& stats) {
+    size_t kept = 0;
+    for (size_t i = 0; i + stride <= vertices.size(); i += stride) {
+        if (isInvisible(&vertices[i], stride)) {
+            ++stats.transparent;
+            continue;
+        }
+        if (kept != i) std::copy(vertices.begin() + i, vertices.begin() + i + stride, vertices.begin() + kept);
+        kept += stride;
+    }
+    vertices.resize(kept);
+}
+
+void optimizeGeometry(DrawGridAPIImpl& impl) {
+    static constexpr DrawGridAPI::DrawMode DRAW_MODES[] = {DrawGridAPI::DrawMode::NORMAL, DrawGridAPI::DrawMode::BLEND, DrawGridAPI::DrawMode::INVERT};
+
+    auto& buffers = impl.m_buffers;
+    DrawGridAPI::GeometryStats stats;
+
+    for (auto drawMode : DRAW_MODES) {
+        for (auto& [_, vertices] : buffers.lineBuckets(drawMode)) {
+            optimizeLines(buffers.m_arena, vertices, drawMode == DrawGridAPI::DrawMode::NORMAL, stats);
+        }
+        dropInvisible(buffers.rects(drawMode), 6, stats);
+        dropInvisible(buffers.rectOutlines(drawMode), 24, stats);
+    }
+    impl.m_geometryStats = stats;
+}
+
+void DrawGridAPI::setGeometryOptimization(bool enabled) {
+    m_impl->m_optimizeGeometry = enabled;
+    if (!enabled) m_impl->m_geometryStats = {};
+}
+
+bool DrawGridAPI::isGeometryOptimization() {
+    return m_impl->m_optimizeGeometry;
+}
+
+DrawGridAPI::GeometryStats DrawGridAPI::getGeometryStats() {
+    return m_impl->m_geometryStats;
+}
@@ -0,0 +1,31 @@
+#include <Geode/Geode.hpp>
+#include <Geode/modify/LevelEditorLayer.hpp>
+#include "../include/DrawGridAPI.hpp"
+
+using namespace geode::prelude;
+
+class $modify(MyLevelEditorLayer, LevelEditorLayer) {
+
+    struct Fields {
+        // the GL context is still current here, which it may not be by the next editor
+        ~Fields() {
+            DrawGridAPI::get().releasePersistentBuffers();
+        }
+    };
+
+    void addSpecial(GameObject* p0) {
+        LevelEditorLayer::addSpecial(p0);
+        DrawGridAPI::get().invalidateTriggerTables();
+    }
+
+    void removeSpecial(GameObject* p0) {
+        LevelEditorLayer::removeSpecial(p0);
+        DrawGridAPI::get().invalidateTriggerTables();
+    }
+
+    // everything the playtest moved is put back
+    void onStopPlaytest() {
+        LevelEditorLayer::onStopPlaytest();
+        DrawGridAPI::get().invalidateTriggerTables();
+    }
+};
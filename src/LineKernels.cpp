@@ -0,0 +1,286 @@
+#include "LineKernels.hpp"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define GOOD_GRID_KERNELS_X86
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define GOOD_GRID_KERNELS_NEON
+    #include <arm_neon.h>
+#endif
+
+#if defined(__clang__) || defined(__GNUC__)
+    #define GOOD_GRID_TARGET(x) __attribute__((target(x)))
+#else
+    #define GOOD_GRID_TARGET(x)
+#endif
+
+// a fused multiply add would round differently than the SIMD paths, so keep them apart
+#if defined(__clang__)
+    #pragma clang fp contract(off)
+#elif defined(__GNUC__)
+    #pragma GCC optimize("fp-contract=off")
+#endif
+
+static_assert(sizeof(Vertex) == 16, "line kernels write vertices as 16 byte lanes");
+static_assert(offsetof(Vertex, color) == 8, "line kernels expect the color right after the position");
+
+namespace LineKernels {
+
+static uint32_t floatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static void writeScalarLine(Vertex* out, const LineRun& run, size_t i) {
+    const float along = run.origin + run.step * static_cast<float>(run.first + static_cast<int>(i));
+    const uint32_t alongBits = floatBits(along);
+
+    uint32_t lanes[8] = {
+        alongBits, floatBits(run.from), run.colorA, 0,
+        alongBits, floatBits(run.to),   run.colorB, 0
+    };
+
+    if (!run.vertical) {
+        lanes[0] = floatBits(run.from);
+        lanes[1] = alongBits;
+        lanes[4] = floatBits(run.to);
+        lanes[5] = alongBits;
+    }
+
+    std::memcpy(out + i * 2, lanes, sizeof(lanes));
+}
+
+void emitScalar(Vertex* out, const LineRun& run) {
+    for (size_t i = 0; i < run.count; ++i) {
+        writeScalarLine(out, run, i);
+    }
+}
+
+#ifdef GOOD_GRID_KERNELS_X86
+
+template <bool Vertical, int Lane>
+static void writeSSE2Line(float* out, __m128 along, __m128 templateA, __m128 templateB) {
+    const __m128 value = _mm_shuffle_ps(along, along, _MM_SHUFFLE(Lane, Lane, Lane, Lane));
+    if constexpr (Vertical) {
+        _mm_storeu_ps(out + Lane * 8, _mm_move_ss(templateA, value));
+        _mm_storeu_ps(out + Lane * 8 + 4, _mm_move_ss(templateB, value));
+    } else {
+        const __m128 lowA = _mm_unpacklo_ps(templateA, value);
+        const __m128 lowB = _mm_unpacklo_ps(templateB, value);
+        _mm_storeu_ps(out + Lane * 8, _mm_shuffle_ps(lowA, templateA, _MM_SHUFFLE(3, 2, 1, 0)));
+        _mm_storeu_ps(out + Lane * 8 + 4, _mm_shuffle_ps(lowB, templateB, _MM_SHUFFLE(3, 2, 1, 0)));
+    }
+}
+
+template <bool Vertical>
+static void emitSSE2Impl(Vertex* out, const LineRun& run) {
+    const int fromBits = static_cast<int>(floatBits(run.from));
+    const int toBits = static_cast<int>(floatBits(run.to));
+    const int colorA = static_cast<int>(run.colorA);
+    const int colorB = static_cast<int>(run.colorB);
+
+    const __m128 templateA = Vertical
+        ? _mm_castsi128_ps(_mm_setr_epi32(0, fromBits, colorA, 0))
+        : _mm_castsi128_ps(_mm_setr_epi32(fromBits, 0, colorA, 0));
+    const __m128 templateB = Vertical
+        ? _mm_castsi128_ps(_mm_setr_epi32(0, toBits, colorB, 0))
+        : _mm_castsi128_ps(_mm_setr_epi32(toBits, 0, colorB, 0));
+
+    const __m128 origin = _mm_set1_ps(run.origin);
+    const __m128 step = _mm_set1_ps(run.step);
+    const __m128i laneOffsets = _mm_setr_epi32(0, 1, 2, 3);
+
+    size_t i = 0;
+    for (; i + 4 <= run.count; i += 4) {
+        const __m128i index = _mm_add_epi32(_mm_set1_epi32(run.first + static_cast<int>(i)), laneOffsets);
+        const __m128 along = _mm_add_ps(origin, _mm_mul_ps(step, _mm_cvtepi32_ps(index)));
+        float* dst = reinterpret_cast<float*>(out + i * 2);
+
+        writeSSE2Line<Vertical, 0>(dst, along, templateA, templateB);
+        writeSSE2Line<Vertical, 1>(dst, along, templateA, templateB);
+        writeSSE2Line<Vertical, 2>(dst, along, templateA, templateB);
+        writeSSE2Line<Vertical, 3>(dst, along, templateA, templateB);
+    }
+
+    for (; i < run.count; ++i) {
+        writeScalarLine(out, run, i);
+    }
+}
+
+static void emitSSE2(Vertex* out, const LineRun& run) {
+    if (run.vertical) emitSSE2Impl<true>(out, run);
+    else emitSSE2Impl<false>(out, run);
+}
+
+template <bool Vertical>
+GOOD_GRID_TARGET("avx2")
+static void emitAVX2Impl(Vertex* out, const LineRun& run) {
+    const int fromBits = static_cast<int>(floatBits(run.from));
+    const int toBits = static_cast<int>(floatBits(run.to));
+    const int colorA = static_cast<int>(run.colorA);
+    const int colorB = static_cast<int>(run.colorB);
+
+    // one 256 bit lane pair is exactly one line (two vertices)
+    const __m256 lineTemplate = Vertical
+        ? _mm256_castsi256_ps(_mm256_setr_epi32(0, fromBits, colorA, 0, 0, toBits, colorB, 0))
+        : _mm256_castsi256_ps(_mm256_setr_epi32(fromBits, 0, colorA, 0, toBits, 0, colorB, 0));
+    constexpr int blendMask = Vertical ? 0x11 : 0x22;
+
+    const __m256 origin = _mm256_set1_ps(run.origin);
+    const __m256 step = _mm256_set1_ps(run.step);
+    const __m256i laneOffsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    size_t i = 0;
+    for (; i + 8 <= run.count; i += 8) {
+        const __m256i index = _mm256_add_epi32(_mm256_set1_epi32(run.first + static_cast<int>(i)), laneOffsets);
+        const __m256 along = _mm256_add_ps(origin, _mm256_mul_ps(step, _mm256_cvtepi32_ps(index)));
+        float* dst = reinterpret_cast<float*>(out + i * 2);
+
+        for (int lane = 0; lane < 8; ++lane) {
+            const __m256 value = _mm256_permutevar8x32_ps(along, _mm256_set1_epi32(lane));
+            _mm256_storeu_ps(dst + lane * 8, _mm256_blend_ps(lineTemplate, value, blendMask));
+        }
+    }
+
+    for (; i < run.count; ++i) {
+        writeScalarLine(out, run, i);
+    }
+}
+
+GOOD_GRID_TARGET("avx2")
+static void emitAVX2(Vertex* out, const LineRun& run) {
+    if (run.vertical) emitAVX2Impl<true>(out, run);
+    else emitAVX2Impl<false>(out, run);
+}
+
+static bool hasAVX2() {
+    unsigned int regs[4] = {};
+    #ifdef _MSC_VER
+        int info[4];
+        __cpuidex(info, 0, 0);
+        if (info[0] < 7) return false;
+        __cpuidex(info, 1, 0);
+        regs[2] = static_cast<unsigned int>(info[2]);
+    #else
+        if (__get_cpuid_max(0, nullptr) < 7) return false;
+        __cpuid_count(1, 0, regs[0], regs[1], regs[2], regs[3]);
+    #endif
+
+    // AVX state has to be enabled by the OS as well, not just supported by the CPU
+    const bool osxsave = regs[2] & (1u << 27);
+    const bool avx = regs[2] & (1u << 28);
+    if (!osxsave || !avx) return false;
+
+    #if defined(_MSC_VER) && !defined(__clang__)
+        const unsigned long long xcr0 = _xgetbv(0);
+    #else
+        unsigned int xcr0Low, xcr0High;
+        __asm__ volatile("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+        const unsigned long long xcr0 = (static_cast<unsigned long long>(xcr0High) << 32) | xcr0Low;
+    #endif
+    if ((xcr0 & 0x6) != 0x6) return false;
+
+    #ifdef _MSC_VER
+        __cpuidex(info, 7, 0);
+        regs[1] = static_cast<unsigned int>(info[1]);
+    #else
+        __cpuid_count(7, 0, regs[0], regs[1], regs[2], regs[3]);
+    #endif
+    return regs[1] & (1u << 5);
+}
+
+#endif
+
+#ifdef GOOD_GRID_KERNELS_NEON
+
+template <bool Vertical, int Lane>
+static void writeNEONLine(float* out, float32x4_t along, float32x4_t templateA, float32x4_t templateB) {
+    const float value = vgetq_lane_f32(along, Lane);
+    constexpr int target = Vertical ? 0 : 1;
+    vst1q_f32(out + Lane * 8, vsetq_lane_f32(value, templateA, target));
+    vst1q_f32(out + Lane * 8 + 4, vsetq_lane_f32(value, templateB, target));
+}
+
+template <bool Vertical>
+static void emitNEONImpl(Vertex* out, const LineRun& run) {
+    const uint32_t fromBits = floatBits(run.from);
+    const uint32_t toBits = floatBits(run.to);
+
+    const uint32_t lanesA[4] = { Vertical ? 0 : fromBits, Vertical ? fromBits : 0, run.colorA, 0 };
+    const uint32_t lanesB[4] = { Vertical ? 0 : toBits, Vertical ? toBits : 0, run.colorB, 0 };
+    const float32x4_t templateA = vreinterpretq_f32_u32(vld1q_u32(lanesA));
+    const float32x4_t templateB = vreinterpretq_f32_u32(vld1q_u32(lanesB));
+
+    const float32x4_t origin = vdupq_n_f32(run.origin);
+    const float32x4_t step = vdupq_n_f32(run.step);
+    const int32_t offsets[4] = { 0, 1, 2, 3 };
+    const int32x4_t laneOffsets = vld1q_s32(offsets);
+
+    size_t i = 0;
+    for (; i + 4 <= run.count; i += 4) {
+        const int32x4_t index = vaddq_s32(vdupq_n_s32(run.first + static_cast<int>(i)), laneOffsets);
+        const float32x4_t along = vaddq_f32(origin, vmulq_f32(step, vcvtq_f32_s32(index)));
+        float* dst = reinterpret_cast<float*>(out + i * 2);
+
+        writeNEONLine<Vertical, 0>(dst, along, templateA, templateB);
+        writeNEONLine<Vertical, 1>(dst, along, templateA, templateB);
+        writeNEONLine<Vertical, 2>(dst, along, templateA, templateB);
+        writeNEONLine<Vertical, 3>(dst, along, templateA, templateB);
+    }
+
+    for (; i < run.count; ++i) {
+        writeScalarLine(out, run, i);
+    }
+}
+
+static void emitNEON(Vertex* out, const LineRun& run) {
+    if (run.vertical) emitNEONImpl<true>(out, run);
+    else emitNEONImpl<false>(out, run);
+}
+
+#endif
+
+static KernelChoice chooseKernel() {
+    #if defined(GOOD_GRID_KERNELS_X86)
+        if (hasAVX2()) return { emitAVX2, "avx2" };
+        return { emitSSE2, "sse2" };
+    #elif defined(GOOD_GRID_KERNELS_NEON)
+        return { emitNEON, "neon" };
+    #else
+        return { emitScalar, "scalar" };
+    #endif
+}
+
+std::vector<KernelChoice> getKernels() {
+    std::vector<KernelChoice> kernels = { { emitScalar, "scalar" } };
+    #if defined(GOOD_GRID_KERNELS_X86)
+        kernels.push_back({ emitSSE2, "sse2" });
+        if (hasAVX2()) kernels.push_back({ emitAVX2, "avx2" });
+    #elif defined(GOOD_GRID_KERNELS_NEON)
+        kernels.push_back({ emitNEON, "neon" });
+    #endif
+    return kernels;
+}
+
+static const KernelChoice& getKernel() {
+    static const KernelChoice choice = chooseKernel();
+    return choice;
+}
+
+void emit(Vertex* out, const LineRun& run) {
+    if (run.count == 0) return;
+    getKernel().kernel(out, run);
+}
+
+const char* getKernelName() {
+    return getKernel().name;
+}
+
+}
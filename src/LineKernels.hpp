@@ -0,0 +1,39 @@
+#pragma once
+
+#include "../include/DrawGridAPI.hpp"
+
+/*
+    Kernels for writing runs of evenly spaced, axis aligned lines straight into a vertex buffer.
+    Line i of a run sits at origin + step * (first + i) along the run axis and spans from -> to on
+    the other axis. Every kernel computes that with a separate multiply and add (never fused), so
+    the SIMD paths produce the exact same bytes as the scalar one.
+*/
+namespace LineKernels {
+    struct LineRun {
+        float origin;
+        float step;
+        int first;
+        size_t count;
+        float from;
+        float to;
+        uint32_t colorA;
+        uint32_t colorB;
+        bool vertical;
+    };
+
+    using Kernel = void(*)(Vertex* out, const LineRun& run);
+
+    struct KernelChoice {
+        Kernel kernel;
+        const char* name;
+    };
+
+    void emitScalar(Vertex* out, const LineRun& run);
+
+    // every kernel this CPU can run, scalar first, so they can be checked against each other
+    std::vector<KernelChoice> getKernels();
+
+    // writes run.count * 2 vertices to out using the best kernel the CPU supports
+    void emit(Vertex* out, const LineRun& run);
+    const char* getKernelName();
+}
@@ -0,0 +1,319 @@
+#include "MarkerTexture.hpp"
+#include <algorithm>
+#include <cstring>
+#include <Geode/Geode.hpp>
+
+using namespace geode::prelude;
+
+static constexpr int LEVELS = 10;
+static constexpr uint32_t ROW_WIDTH = 2048;
+static constexpr uint32_t INITIAL_EXTENT = 1 << 16;
+static constexpr uint32_t MAX_EXTENT = 1 << 22;
+// widths are stored as a fraction of this
+static constexpr float MAX_WIDTH = 16;
+static constexpr const char* PROGRAM_KEY = "good-grid/marker-texture";
+
+static constexpr const char* VERTEX_SHADER = R"(
+attribute vec4 a_position;
+varying float v_worldX;
+
+void main() {
+    gl_Position = CC_MVPMatrix * a_position;
+    v_worldX = a_position.x;
+}
+)";
+
+static constexpr const char* FRAGMENT_SHADER = R"(
+#ifdef GL_ES
+#ifdef GL_FRAGMENT_PRECISION_HIGH
+precision highp float;
+#endif
+#endif
+
+varying float v_worldX;
+uniform sampler2D u_colors;
+uniform sampler2D u_placement;
+uniform float u_origin;
+uniform float u_texelSize;
+uniform float u_rows;
+uniform float u_texels;
+uniform float u_pixelsPerUnit;
+
+const float ROW_WIDTH = 2048.0;
+
+vec4 markerAt(float index) {
+    if (index < 0.0 || index >= u_texels) return vec4(0.0);
+    vec2 uv = vec2((mod(index, ROW_WIDTH) + 0.5) / ROW_WIDTH, (floor(index / ROW_WIDTH) + 0.5) / u_rows);
+    vec4 placement = texture2D(u_placement, uv);
+    float markerX = u_origin + (index + placement.r) * u_texelSize;
+    float halfWidth = max(placement.a * 8.0, 0.5);
+    if (abs(v_worldX - markerX) * u_pixelsPerUnit > halfWidth) return vec4(0.0);
+    return texture2D(u_colors, uv);
+}
+
+void main() {
+    float index = floor((v_worldX - u_origin) / u_texelSize);
+    vec4 color = markerAt(index);
+    if (color.a == 0.0) color = markerAt(index - 1.0);
+    if (color.a == 0.0) color = markerAt(index + 1.0);
+    if (color.a == 0.0) discard;
+    gl_FragColor = color;
+}
+)";
+
+static bool sameColor(const ccColor4B& a, const ccColor4B& b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+static GLuint createTexture(GLenum format, uint32_t rows, const GLubyte* data) {
+    GLuint texture;
+    glGenTextures(1, &texture);
+    ccGLBindTexture2D(texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, format, ROW_WIDTH, rows, 0, format, GL_UNSIGNED_BYTE, data);
+    return texture;
+}
+
+MarkerTexture::MarkerTexture(float origin) : m_origin(origin) {}
+
+MarkerTexture::~MarkerTexture() {
+    for (auto& level : m_levels) {
+        if (level.m_colorTexture) ccGLDeleteTexture(level.m_colorTexture);
+        if (level.m_placementTexture) ccGLDeleteTexture(level.m_placementTexture);
+    }
+}
+
+bool MarkerTexture::needsUpdate(uint64_t inputs) {
+    if (m_hasInputs && m_inputs == inputs) return false;
+    m_hasInputs = true;
+    m_inputs = inputs;
+    return true;
+}
+
+void MarkerTexture::beginUpdate() {
+    ++m_sweep;
+}
+
+bool MarkerTexture::setMarker(uint64_t key, float x, const ccColor4B& color, float width) {
+    if (x < m_origin) return false;
+    const double offset = static_cast<double>(x) - m_origin;
+    if (offset >= m_extent) {
+        if (offset >= MAX_EXTENT) return false;
+        uint32_t extent = std::max(m_extent, INITIAL_EXTENT);
+        while (extent <= offset) extent *= 2;
+        resize(extent);
+    }
+
+    auto [it, inserted] = m_markers.try_emplace(key);
+    auto& marker = it->second;
+    marker.m_sweep = m_sweep;
+    if (!inserted) {
+        if (marker.m_x == x && marker.m_width == width && sameColor(marker.m_color, color)) return true;
+        markDirty(marker.m_x);
+        m_positions.erase(marker.m_position);
+    }
+
+    marker.m_x = x;
+    marker.m_color = color;
+    marker.m_width = width;
+    marker.m_position = m_positions.emplace(x, key);
+    m_maxWidth = std::max(m_maxWidth, std::min(width, MAX_WIDTH));
+    markDirty(x);
+    return true;
+}
+
+void MarkerTexture::endUpdate() {
+    for (auto it = m_markers.begin(); it != m_markers.end();) {
+        if (it->second.m_sweep == m_sweep) {
+            ++it;
+            continue;
+        }
+        markDirty(it->second.m_x);
+        m_positions.erase(it->second.m_position);
+        it = m_markers.erase(it);
+    }
+
+    if (m_extent == 0) resize(INITIAL_EXTENT);
+
+    if (m_rebuild) {
+        // one pass over the sorted markers per level, the first of the most opaque ones wins each texel
+        for (int levelIndex = 0; levelIndex < LEVELS; ++levelIndex) {
+            auto& level = m_levels[levelIndex];
+            std::fill(level.m_colors.begin(), level.m_colors.end(), 0);
+            std::fill(level.m_placement.begin(), level.m_placement.end(), 0);
+
+            const float texelSize = static_cast<float>(1 << levelIndex);
+            for (const auto& [x, key] : m_positions) {
+                const auto& marker = m_markers[key];
+                const float offset = (x - m_origin) / texelSize;
+                const auto index = static_cast<uint32_t>(offset);
+                if (index >= level.m_texels || marker.m_color.a <= level.m_colors[index * 4 + 3]) continue;
+
+                std::memcpy(&level.m_colors[index * 4], &marker.m_color, 4);
+                level.m_placement[index * 2] = static_cast<GLubyte>((offset - index) * 255.f);
+                level.m_placement[index * 2 + 1] = static_cast<GLubyte>(std::min(marker.m_width, MAX_WIDTH) / MAX_WIDTH * 255.f);
+            }
+            upload(level, true);
+        }
+        m_dirty.clear();
+        m_rebuild = false;
+        return;
+    }
+
+    if (m_dirty.empty()) return;
+
+    std::vector<uint32_t> indices;
+    for (int levelIndex = 0; levelIndex < LEVELS; ++levelIndex) {
+        indices.clear();
+        for (float x : m_dirty) {
+            indices.push_back(static_cast<uint32_t>((x - m_origin) / static_cast<float>(1 << levelIndex)));
+        }
+        std::sort(indices.begin(), indices.end());
+        indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+        for (uint32_t index : indices) updateTexel(levelIndex, index);
+        upload(m_levels[levelIndex], false);
+    }
+    m_dirty.clear();
+}
+
+void MarkerTexture::markDirty(float x) {
+    if (!m_rebuild) m_dirty.push_back(x);
+}
+
+void MarkerTexture::resize(uint32_t extent) {
+    for (auto& level : m_levels) {
+        if (level.m_colorTexture) ccGLDeleteTexture(level.m_colorTexture);
+        if (level.m_placementTexture) ccGLDeleteTexture(level.m_placementTexture);
+    }
+
+    m_extent = extent;
+    m_levels.assign(LEVELS, Level{});
+    for (int levelIndex = 0; levelIndex < LEVELS; ++levelIndex) {
+        auto& level = m_levels[levelIndex];
+        level.m_texels = std::max<uint32_t>(extent >> levelIndex, 1);
+        level.m_rows = (level.m_texels + ROW_WIDTH - 1) / ROW_WIDTH;
+        level.m_colors.resize(static_cast<size_t>(level.m_rows) * ROW_WIDTH * 4);
+        level.m_placement.resize(static_cast<size_t>(level.m_rows) * ROW_WIDTH * 2);
+    }
+    m_dirty.clear();
+    m_rebuild = true;
+}
+
+void MarkerTexture::updateTexel(int levelIndex, uint32_t index) {
+    auto& level = m_levels[levelIndex];
+    if (index >= level.m_texels) return;
+
+    const float texelSize = static_cast<float>(1 << levelIndex);
+    const float start = m_origin + index * texelSize;
+    const float end = start + texelSize;
+
+    const Marker* best = nullptr;
+    for (auto it = m_positions.lower_bound(start); it != m_positions.end() && it->first < end; ++it) {
+        const auto& marker = m_markers[it->second];
+        if (!best || marker.m_color.a > best->m_color.a) best = &marker;
+    }
+
+    if (best) {
+        std::memcpy(&level.m_colors[index * 4], &best->m_color, 4);
+        level.m_placement[index * 2] = static_cast<GLubyte>((best->m_x - start) / texelSize * 255.f);
+        level.m_placement[index * 2 + 1] = static_cast<GLubyte>(std::min(best->m_width, MAX_WIDTH) / MAX_WIDTH * 255.f);
+    }
+    else {
+        std::memset(&level.m_colors[index * 4], 0, 4);
+        std::memset(&level.m_placement[index * 2], 0, 2);
+    }
+
+    const int row = static_cast<int>(index / ROW_WIDTH);
+    level.m_dirtyFrom = std::min(level.m_dirtyFrom, row);
+    level.m_dirtyTo = std::max(level.m_dirtyTo, row);
+}
+
+void MarkerTexture::upload(Level& level, bool full) {
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (full || !level.m_colorTexture) {
+        if (level.m_colorTexture) ccGLDeleteTexture(level.m_colorTexture);
+        if (level.m_placementTexture) ccGLDeleteTexture(level.m_placementTexture);
+        level.m_colorTexture = createTexture(GL_RGBA, level.m_rows, level.m_colors.data());
+        level.m_placementTexture = createTexture(GL_LUMINANCE_ALPHA, level.m_rows, level.m_placement.data());
+    }
+    else if (level.m_dirtyTo >= level.m_dirtyFrom) {
+        const int rows = level.m_dirtyTo - level.m_dirtyFrom + 1;
+        ccGLBindTexture2D(level.m_colorTexture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, level.m_dirtyFrom, ROW_WIDTH, rows, GL_RGBA, GL_UNSIGNED_BYTE, &level.m_colors[static_cast<size_t>(level.m_dirtyFrom) * ROW_WIDTH * 4]);
+        ccGLBindTexture2D(level.m_placementTexture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, level.m_dirtyFrom, ROW_WIDTH, rows, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, &level.m_placement[static_cast<size_t>(level.m_dirtyFrom) * ROW_WIDTH * 2]);
+    }
+
+    level.m_dirtyFrom = INT_MAX;
+    level.m_dirtyTo = -1;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+bool MarkerTexture::ensureProgram() {
+    // looked up every time, the cache can be emptied and filled again when the GL context is recreated
+    auto cache = CCShaderCache::sharedShaderCache();
+    auto program = cache->programForKey(PROGRAM_KEY);
+    if (program && program == m_program) return true;
+
+    if (!program) {
+        program = new CCGLProgram();
+        if (!program->initWithVertexShaderByteArray(VERTEX_SHADER, FRAGMENT_SHADER)) {
+            program->release();
+            return false;
+        }
+        program->addAttribute(kCCAttributeNamePosition, kCCVertexAttrib_Position);
+        if (!program->link()) {
+            program->release();
+            return false;
+        }
+        program->updateUniforms();
+        cache->addProgram(program, PROGRAM_KEY);
+        program->release();
+    }
+    m_program = program;
+
+    m_program->use();
+    m_program->setUniformLocationWith1i(m_program->getUniformLocationForName("u_colors"), 0);
+    m_program->setUniformLocationWith1i(m_program->getUniformLocationForName("u_placement"), 1);
+    m_originUniform = m_program->getUniformLocationForName("u_origin");
+    m_texelSizeUniform = m_program->getUniformLocationForName("u_texelSize");
+    m_rowsUniform = m_program->getUniformLocationForName("u_rows");
+    m_texelsUniform = m_program->getUniformLocationForName("u_texels");
+    m_pixelsPerUnitUniform = m_program->getUniformLocationForName("u_pixelsPerUnit");
+    return true;
+}
+
+void MarkerTexture::draw(float minX, float maxX, float minY, float maxY, float pixelsPerUnit) {
+    if (m_markers.empty() || m_levels.empty() || pixelsPerUnit <= 0 || !ensureProgram()) return;
+
+    minX = std::max(minX, m_origin);
+    maxX = std::min(maxX, m_origin + m_extent);
+    if (maxX <= minX) return;
+
+    // texels at least as wide as the widest line so the neighbouring texels cover all of it
+    const float needed = std::max(1.f, m_maxWidth * 0.5f) / pixelsPerUnit;
+    int levelIndex = 0;
+    while (levelIndex + 1 < LEVELS && static_cast<float>(1 << levelIndex) < needed) ++levelIndex;
+    auto& level = m_levels[levelIndex];
+
+    m_program->use();
+    m_program->setUniformsForBuiltins();
+    m_program->setUniformLocationWith1f(m_originUniform, m_origin);
+    m_program->setUniformLocationWith1f(m_texelSizeUniform, static_cast<float>(1 << levelIndex));
+    m_program->setUniformLocationWith1f(m_rowsUniform, static_cast<float>(level.m_rows));
+    m_program->setUniformLocationWith1f(m_texelsUniform, static_cast<float>(level.m_texels));
+    m_program->setUniformLocationWith1f(m_pixelsPerUnitUniform, pixelsPerUnit);
+
+    ccGLBindTexture2DN(1, level.m_placementTexture);
+    ccGLBindTexture2DN(0, level.m_colorTexture);
+
+    const GLfloat quad[] = {minX, minY, maxX, minY, minX, maxY, maxX, maxY};
+    ccGLEnableVertexAttribs(kCCVertexAttribFlag_Position);
+    glVertexAttribPointer(kCCVertexAttrib_Position, 2, GL_FLOAT, GL_FALSE, 0, quad);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+}
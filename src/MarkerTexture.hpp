@@ -0,0 +1,79 @@
+#pragma once
+
+#include "../include/DrawGridAPI.hpp"
+#include <climits>
+#include <map>
+#include <unordered_map>
+
+/*
+    Vertical markers rasterized by X into textures instead of drawn as lines, drawn with a single quad whose
+    fragment shader looks up the closest marker for its world X. Each level has texels twice as wide as the
+    one before, keeping the most opaque marker in each, so any zoom costs the same three lookups per pixel.
+    Only texels whose markers changed are uploaded again, and the markers only have to be set again when what
+    they're made from changes, see needsUpdate.
+*/
+class MarkerTexture {
+public:
+    MarkerTexture(float origin);
+    ~MarkerTexture();
+    MarkerTexture(const MarkerTexture&) = delete;
+    MarkerTexture& operator=(const MarkerTexture&) = delete;
+
+    // false if the markers were last set from the same inputs, so drawing it again is all that's needed
+    bool needsUpdate(uint64_t inputs);
+    // markers that aren't set again between beginUpdate and endUpdate are removed
+    void beginUpdate();
+    // false if x is outside what the texture covers, the caller has to draw that one as a line
+    bool setMarker(uint64_t key, float x, const cocos2d::ccColor4B& color, float width);
+    void endUpdate();
+
+    // render thread only, with whatever modelview the grid is drawn with
+    void draw(float minX, float maxX, float minY, float maxY, float pixelsPerUnit);
+
+private:
+    struct Marker {
+        float m_x;
+        cocos2d::ccColor4B m_color;
+        float m_width;
+        uint32_t m_sweep;
+        std::multimap<float, uint64_t>::iterator m_position;
+    };
+
+    struct Level {
+        GLuint m_colorTexture = 0;
+        GLuint m_placementTexture = 0;
+        // RGBA per texel
+        std::vector<GLubyte> m_colors;
+        // offset of the marker inside the texel and its width, two bytes per texel
+        std::vector<GLubyte> m_placement;
+        uint32_t m_texels = 0;
+        uint32_t m_rows = 0;
+        int m_dirtyFrom = INT_MAX;
+        int m_dirtyTo = -1;
+    };
+
+    void markDirty(float x);
+    void resize(uint32_t extent);
+    void updateTexel(int level, uint32_t index);
+    void upload(Level& level, bool full);
+    bool ensureProgram();
+
+    float m_origin;
+    uint32_t m_extent = 0;
+    uint32_t m_sweep = 0;
+    float m_maxWidth = 1;
+    bool m_rebuild = true;
+    bool m_hasInputs = false;
+    uint64_t m_inputs = 0;
+    std::unordered_map<uint64_t, Marker> m_markers;
+    std::multimap<float, uint64_t> m_positions;
+    std::vector<float> m_dirty;
+    std::vector<Level> m_levels;
+    // kept alive so a program put in the cache under the same key later can't be mistaken for it
+    geode::Ref<cocos2d::CCGLProgram> m_program = nullptr;
+    GLint m_originUniform = -1;
+    GLint m_texelSizeUniform = -1;
+    GLint m_rowsUniform = -1;
+    GLint m_texelsUniform = -1;
+    GLint m_pixelsPerUnitUniform = -1;
+};
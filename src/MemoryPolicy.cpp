@@ -0,0 +1,121 @@
+#include "../include/DrawGridAPI.hpp"
+#include "DrawGridAPIImpl.hpp"
+#include <Geode/Geode.hpp>
+
+using namespace geode::prelude;
+
+static constexpr DrawGridAPI::DrawMode DRAW_MODES[] = {DrawGridAPI::DrawMode::NORMAL, DrawGridAPI::DrawMode::BLEND, DrawGridAPI::DrawMode::INVERT};
+
+static void shrinkTo(std::vector<Vertex>& vertices, size_t capacity) {
+    if (vertices.capacity() <= capacity) return;
+    // the buffers get reset right after, so nothing needs copying over
+    std::vector<Vertex> smaller;
+    smaller.reserve(capacity);
+    vertices.swap(smaller);
+}
+
+// returns true once the bucket has gone unused for long enough that it can be dropped entirely
+static bool updateBucket(MemoryPolicy& policy, const BufferBucketKey& key, std::vector<Vertex>& vertices) {
+    auto& usage = policy.m_usage[key];
+    usage.m_used = vertices.size();
+
+    if (vertices.size() * 2 >= vertices.capacity()) {
+        usage.m_quietFrames = 0;
+        usage.m_peak = 0;
+        return false;
+    }
+
+    usage.m_peak = std::max(usage.m_peak, vertices.size());
+    if (++usage.m_quietFrames < policy.m_shrinkDelay) return false;
+
+    const bool unused = usage.m_peak == 0;
+    shrinkTo(vertices, usage.m_peak + usage.m_peak / 4);
+    usage.m_quietFrames = 0;
+    usage.m_peak = 0;
+    return unused;
+}
+
+static size_t reservedBytes(VertexBuffers& buffers) {
+    size_t bytes = 0;
+    for (auto drawMode : DRAW_MODES) {
+        for (const auto& [_, vertices] : buffers.lineBuckets(drawMode)) bytes += vertices.capacity() * sizeof(Vertex);
+        bytes += buffers.rects(drawMode).capacity() * sizeof(Vertex);
+        bytes += buffers.rectOutlines(drawMode).capacity() * sizeof(Vertex);
+    }
+    return bytes;
+}
+
+void applyMemoryPolicy(DrawGridAPIImpl& impl) {
+    auto& policy = impl.m_memory;
+    auto& buffers = impl.m_buffers;
+
+    for (auto drawMode : DRAW_MODES) {
+        auto& lineBuckets = buffers.lineBuckets(drawMode);
+        for (auto it = lineBuckets.begin(); it != lineBuckets.end();) {
+            const BufferBucketKey key{drawMode, PrimitiveKind::LINE, it->first};
+            if (updateBucket(policy, key, it->second)) {
+                policy.m_usage.erase(key);
+                it = lineBuckets.erase(it);
+            }
+            else ++it;
+        }
+        updateBucket(policy, {drawMode, PrimitiveKind::RECT, 0}, buffers.rects(drawMode));
+        updateBucket(policy, {drawMode, PrimitiveKind::RECT_OUTLINE, 0}, buffers.rectOutlines(drawMode));
+    }
+
+    if (policy.m_budget == 0 || reservedBytes(buffers) <= policy.m_budget) return;
+
+    for (auto drawMode : DRAW_MODES) {
+        auto& lineBuckets = buffers.lineBuckets(drawMode);
+        for (auto it = lineBuckets.begin(); it != lineBuckets.end();) {
+            if (it->second.empty()) {
+                policy.m_usage.erase({drawMode, PrimitiveKind::LINE, it->first});
+                it = lineBuckets.erase(it);
+                continue;
+            }
+            shrinkTo(it->second, it->second.size());
+            ++it;
+        }
+        shrinkTo(buffers.rects(drawMode), buffers.rects(drawMode).size());
+        shrinkTo(buffers.rectOutlines(drawMode), buffers.rectOutlines(drawMode).size());
+    }
+}
+
+void DrawGridAPI::setMemoryBudget(size_t bytes) {
+    m_impl->m_memory.m_budget = bytes;
+}
+
+size_t DrawGridAPI::getMemoryBudget() {
+    return m_impl->m_memory.m_budget;
+}
+
+void DrawGridAPI::setShrinkDelay(int frames) {
+    m_impl->m_memory.m_shrinkDelay = std::max(frames, 1);
+}
+
+DrawGridAPI::MemoryStats DrawGridAPI::getMemoryStats() {
+    auto& policy = m_impl->m_memory;
+    auto& buffers = m_impl->m_buffers;
+
+    MemoryStats stats;
+    stats.budgetBytes = policy.m_budget;
+
+    auto addBucket = [&](DrawMode drawMode, PrimitiveKind kind, float width, const std::vector<Vertex>& vertices) {
+        auto usage = policy.m_usage.find({drawMode, kind, width});
+        MemoryStats::Bucket bucket{drawMode, kind, width};
+        bucket.usedBytes = usage != policy.m_usage.end() ? usage->second.m_used * sizeof(Vertex) : 0;
+        bucket.reservedBytes = vertices.capacity() * sizeof(Vertex);
+        stats.usedBytes += bucket.usedBytes;
+        stats.reservedBytes += bucket.reservedBytes;
+        stats.buckets.push_back(bucket);
+    };
+
+    for (auto drawMode : DRAW_MODES) {
+        for (const auto& [width, vertices] : buffers.lineBuckets(drawMode)) {
+            addBucket(drawMode, PrimitiveKind::LINE, width, vertices);
+        }
+        addBucket(drawMode, PrimitiveKind::RECT, 0, buffers.rects(drawMode));
+        addBucket(drawMode, PrimitiveKind::RECT_OUTLINE, 0, buffers.rectOutlines(drawMode));
+    }
+    return stats;
+}
@@ -0,0 +1,265 @@
+#include "../include/DrawGridAPI.hpp"
+#include "DrawGridAPIImpl.hpp"
+#include <Geode/Geode.hpp>
+
+using namespace geode::prelude;
+
+// wide enough that a zoomed out view only touches a handful of buckets
+const float PERSISTENT_CHUNK_WIDTH = 2048.f;
+
+static size_t verticesPerPrimitive(PrimitiveKind kind) {
+    switch (kind) {
+        case PrimitiveKind::LINE: return 2;
+        case PrimitiveKind::RECT: return 6;
+        default: return 24;
+    }
+}
+
+static int chunkFor(float x) {
+    return static_cast<int>(std::floor(x / PERSISTENT_CHUNK_WIDTH));
+}
+
+static CCRect boundsOf(const Vertex* vertices, size_t count) {
+    float minX = vertices[0].position.x;
+    float maxX = minX;
+    float minY = vertices[0].position.y;
+    float maxY = minY;
+    for (size_t i = 1; i < count; ++i) {
+        minX = std::min(minX, vertices[i].position.x);
+        maxX = std::max(maxX, vertices[i].position.x);
+        minY = std::min(minY, vertices[i].position.y);
+        maxY = std::max(maxY, vertices[i].position.y);
+    }
+    return CCRect{minX, minY, maxX - minX, maxY - minY};
+}
+
+static CCRect unionOf(const CCRect& a, const CCRect& b) {
+    const float minX = std::min(a.getMinX(), b.getMinX());
+    const float minY = std::min(a.getMinY(), b.getMinY());
+    const float maxX = std::max(a.getMaxX(), b.getMaxX());
+    const float maxY = std::max(a.getMaxY(), b.getMaxY());
+    return CCRect{minX, minY, maxX - minX, maxY - minY};
+}
+
+// only what's left in the bucket counts, so moving or removing primitives can shrink it again
+static const CCRect& boundsOfBucket(PersistentBucket& bucket) {
+    if (bucket.m_boundsStale) {
+        bucket.m_bounds = boundsOf(bucket.m_vertices.data(), bucket.m_vertices.size());
+        bucket.m_boundsStale = false;
+    }
+    return bucket.m_bounds;
+}
+
+static void insertIntoSlot(PersistentStore& store, uint32_t index, PrimitiveKind kind, DrawGridAPI::DrawMode drawMode, float width, const Vertex* vertices, size_t count) {
+    const CCRect bounds = boundsOf(vertices, count);
+    const PersistentBucketKey key{drawMode, kind, width, chunkFor(bounds.getMidX())};
+    auto& bucket = store.m_buckets[key];
+
+    // growing is enough here, a bucket whose bounds are already stale gets them worked out again anyway
+    bucket.m_bounds = bucket.m_owners.empty() ? bounds : unionOf(bucket.m_bounds, bounds);
+    bucket.m_vertices.insert(bucket.m_vertices.end(), vertices, vertices + count);
+    bucket.m_owners.push_back(index);
+    bucket.m_dirty = true;
+
+    auto& slot = store.m_slots[index];
+    slot.m_alive = true;
+    slot.m_key = key;
+    slot.m_position = static_cast<uint32_t>(bucket.m_owners.size() - 1);
+}
+
+// moves the bucket's last primitive into the removed one's place so buckets stay tightly packed
+static void eraseFromBucket(PersistentStore& store, PersistentSlot& slot) {
+    auto it = store.m_buckets.find(slot.m_key);
+    if (it == store.m_buckets.end()) return;
+    auto& bucket = it->second;
+
+    const size_t stride = verticesPerPrimitive(slot.m_key.m_kind);
+    const size_t last = bucket.m_owners.size() - 1;
+    if (slot.m_position != last) {
+        std::copy_n(bucket.m_vertices.begin() + last * stride, stride, bucket.m_vertices.begin() + slot.m_position * stride);
+        bucket.m_owners[slot.m_position] = bucket.m_owners[last];
+        store.m_slots[bucket.m_owners[last]].m_position = slot.m_position;
+    }
+    bucket.m_vertices.resize(last * stride);
+    bucket.m_owners.pop_back();
+    bucket.m_dirty = true;
+    bucket.m_boundsStale = true;
+    slot.m_alive = false;
+
+    if (bucket.m_owners.empty()) {
+        if (bucket.m_vbo) glDeleteBuffers(1, &bucket.m_vbo);
+        store.m_buckets.erase(it);
+    }
+}
+
+static PersistentSlot* findSlot(PersistentStore& store, const PersistentHandle& handle) {
+    if (!handle.isValid() || handle.index >= store.m_slots.size()) return nullptr;
+    auto& slot = store.m_slots[handle.index];
+    if (!slot.m_alive || slot.m_generation != handle.generation) return nullptr;
+    return &slot;
+}
+
+static PersistentHandle addPersistent(PersistentStore& store, PrimitiveKind kind, DrawGridAPI::DrawMode drawMode, float width, const Vertex* vertices, size_t count) {
+    if (drawMode == DrawGridAPI::DrawMode::NONE) return {};
+
+    uint32_t index;
+    if (!store.m_freeSlots.empty()) {
+        index = store.m_freeSlots.back();
+        store.m_freeSlots.pop_back();
+    } else {
+        index = static_cast<uint32_t>(store.m_slots.size());
+        store.m_slots.emplace_back();
+    }
+
+    insertIntoSlot(store, index, kind, drawMode, width, vertices, count);
+    ++store.m_count;
+    return {index, store.m_slots[index].m_generation};
+}
+
+static bool updatePersistent(PersistentStore& store, const PersistentHandle& handle, PrimitiveKind kind, DrawGridAPI::DrawMode drawMode, float width, const Vertex* vertices, size_t count) {
+    auto* slot = findSlot(store, handle);
+    if (!slot || drawMode == DrawGridAPI::DrawMode::NONE) return false;
+
+    // a primitive that stays in its bucket is overwritten in place, anything else moves buckets
+    const PersistentBucketKey key{drawMode, kind, width, chunkFor(boundsOf(vertices, count).getMidX())};
+    if (slot->m_key == key) {
+        auto& bucket = store.m_buckets[key];
+        std::copy_n(vertices, count, bucket.m_vertices.begin() + slot->m_position * count);
+        bucket.m_dirty = true;
+        bucket.m_boundsStale = true;
+        return true;
+    }
+
+    eraseFromBucket(store, *slot);
+    insertIntoSlot(store, handle.index, kind, drawMode, width, vertices, count);
+    return true;
+}
+
+PersistentHandle DrawGridAPI::addPersistentLine(const cocos2d::ccVertex2F& start, const cocos2d::ccVertex2F& end, const LineColor& color, float width, DrawMode drawMode) {
+    const Vertex vertices[2] = {{start, color.getColorA()}, {end, color.getColorB()}};
+    return addPersistent(m_impl->m_persistent, PrimitiveKind::LINE, drawMode, width, vertices, 2);
+}
+
+PersistentHandle DrawGridAPI::addPersistentRect(const cocos2d::CCRect& rect, const cocos2d::ccColor4B& color, DrawMode drawMode) {
+    const auto vertices = rectToTriangles(rect, color);
+    return addPersistent(m_impl->m_persistent, PrimitiveKind::RECT, drawMode, 0, vertices.data(), vertices.size());
+}
+
+PersistentHandle DrawGridAPI::addPersistentRectOutline(const cocos2d::CCRect& rect, const cocos2d::ccColor4B& color, float width, DrawMode drawMode) {
+    const auto vertices = rectToBorderTriangles(rect, color, width);
+    return addPersistent(m_impl->m_persistent, PrimitiveKind::RECT_OUTLINE, drawMode, 0, vertices.data(), vertices.size());
+}
+
+bool DrawGridAPI::updatePersistentLine(const PersistentHandle& handle, const cocos2d::ccVertex2F& start, const cocos2d::ccVertex2F& end, const LineColor& color, float width, DrawMode drawMode) {
+    const Vertex vertices[2] = {{start, color.getColorA()}, {end, color.getColorB()}};
+    return updatePersistent(m_impl->m_persistent, handle, PrimitiveKind::LINE, drawMode, width, vertices, 2);
+}
+
+bool DrawGridAPI::updatePersistentRect(const PersistentHandle& handle, const cocos2d::CCRect& rect, const cocos2d::ccColor4B& color, DrawMode drawMode) {
+    const auto vertices = rectToTriangles(rect, color);
+    return updatePersistent(m_impl->m_persistent, handle, PrimitiveKind::RECT, drawMode, 0, vertices.data(), vertices.size());
+}
+
+bool DrawGridAPI::updatePersistentRectOutline(const PersistentHandle& handle, const cocos2d::CCRect& rect, const cocos2d::ccColor4B& color, float width, DrawMode drawMode) {
+    const auto vertices = rectToBorderTriangles(rect, color, width);
+    return updatePersistent(m_impl->m_persistent, handle, PrimitiveKind::RECT_OUTLINE, drawMode, 0, vertices.data(), vertices.size());
+}
+
+bool DrawGridAPI::removePersistent(const PersistentHandle& handle) {
+    auto& store = m_impl->m_persistent;
+    auto* slot = findSlot(store, handle);
+    if (!slot) return false;
+
+    eraseFromBucket(store, *slot);
+    // bumping the generation makes any copies of the handle stale once the slot is reused
+    if (++slot->m_generation == 0) slot->m_generation = 1;
+    store.m_freeSlots.push_back(handle.index);
+    --store.m_count;
+    return true;
+}
+
+void DrawGridAPI::clearPersistent() {
+    auto& store = m_impl->m_persistent;
+    for (auto& [_, bucket] : store.m_buckets) {
+        if (bucket.m_vbo) glDeleteBuffers(1, &bucket.m_vbo);
+    }
+    store.m_buckets.clear();
+    store.m_freeSlots.clear();
+    for (uint32_t i = 0; i < store.m_slots.size(); ++i) {
+        auto& slot = store.m_slots[i];
+        if (slot.m_alive && ++slot.m_generation == 0) slot.m_generation = 1;
+        slot.m_alive = false;
+        store.m_freeSlots.push_back(i);
+    }
+    store.m_count = 0;
+}
+
+size_t DrawGridAPI::getPersistentCount() {
+    return m_impl->m_persistent.m_count;
+}
+
+void DrawGridAPI::releasePersistentBuffers() {
+    for (auto& [_, bucket] : m_impl->m_persistent.m_buckets) {
+        if (bucket.m_vbo) glDeleteBuffers(1, &bucket.m_vbo);
+        bucket.m_vbo = 0;
+        bucket.m_dirty = true;
+    }
+}
+
+/*
+    The buffers are released when the editor closes, by the next one the GL context may have been recreated and
+    any name left over could belong to something else in the new one, so they're dropped without deleting them.
+    They're created again on the next visible draw.
+*/
+void forgetPersistentBuffers(DrawGridAPIImpl& impl) {
+    for (auto& [_, bucket] : impl.m_persistent.m_buckets) {
+        bucket.m_vbo = 0;
+        bucket.m_dirty = true;
+    }
+}
+
+void drawPersistentPrimitives(DrawGridAPIImpl& impl, DrawGridAPI::DrawMode drawMode, float widthModifier) {
+    auto& buckets = impl.m_persistent.m_buckets;
+    if (buckets.empty()) return;
+
+    const CCRect& visible = impl.m_visibleRect;
+    bool bound = false;
+
+    for (auto it = buckets.lower_bound(PersistentBucketKey{drawMode, PrimitiveKind::LINE, -FLT_MAX, INT_MIN}); it != buckets.end() && it->first.m_drawMode == drawMode; ++it) {
+        auto& [key, bucket] = *it;
+        if (bucket.m_vertices.empty() || !boundsOfBucket(bucket).intersectsRect(visible)) continue;
+
+        if (!bucket.m_vbo) {
+            glGenBuffers(1, &bucket.m_vbo);
+            bucket.m_dirty = true;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, bucket.m_vbo);
+        bound = true;
+
+        if (bucket.m_dirty) {
+            glBufferData(GL_ARRAY_BUFFER, bucket.m_vertices.size() * sizeof(Vertex), bucket.m_vertices.data(), GL_STATIC_DRAW);
+            bucket.m_dirty = false;
+        }
+
+        glVertexAttribPointer(kCCVertexAttrib_Position, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, position)));
+        glVertexAttribPointer(kCCVertexAttrib_Color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, color)));
+
+        if (key.m_kind == PrimitiveKind::LINE) glLineWidth(key.m_width + widthModifier);
+
+        if (impl.m_gpuTimers.m_active) beginGPUTimer(impl);
+        glDrawArrays(key.m_kind == PrimitiveKind::LINE ? GL_LINES : GL_TRIANGLES, 0, bucket.m_vertices.size());
+        if (impl.m_gpuTimers.m_active) endGPUTimer(impl);
+
+        if (impl.m_profiler.m_enabled) recordDrawCall(impl, drawMode, key.m_kind, key.m_width, bucket.m_vertices.size());
+    }
+
+    // the rest of the batch draws from client memory
+    if (bound) glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void capturePersistentPrimitives(DrawGridAPIImpl& impl, CapturedFrame& frame) {
+    for (auto& [key, bucket] : impl.m_persistent.m_buckets) {
+        if (bucket.m_vertices.empty() || !boundsOfBucket(bucket).intersectsRect(impl.m_visibleRect)) continue;
+        frame.m_buckets.push_back({key.m_drawMode, key.m_kind, key.m_width, bucket.m_vertices});
+    }
+}
@@ -0,0 +1,166 @@
+#include "../include/DrawGridAPI.hpp"
+#include "DrawGridAPIImpl.hpp"
+#include <chrono>
+#include <numeric>
+#include <Geode/Geode.hpp>
+
+using namespace geode::prelude;
+
+void beginProfilerFrame(DrawGridAPIImpl& impl) {
+    auto& frame = impl.m_profiler.m_current;
+    frame.frame = impl.m_frameNumber.load(std::memory_order_relaxed);
+    frame.totalMs = 0;
+    frame.drawCalls = 0;
+    frame.buckets.clear();
+    // sized up front so nodes drawing on workers each write only their own entry
+    frame.nodes.clear();
+    frame.nodes.resize(impl.m_drawNodes.size());
+}
+
+void endProfilerFrame(DrawGridAPIImpl& impl, float totalMs) {
+    auto& profiler = impl.m_profiler;
+    auto& frame = profiler.m_current;
+    frame.totalMs = totalMs;
+    std::erase_if(frame.nodes, [](const DrawGridAPI::ProfilerFrame::Node& node) { return node.id.empty(); });
+
+    if (profiler.m_history.size() < PROFILER_HISTORY_SIZE) profiler.m_history.resize(PROFILER_HISTORY_SIZE);
+    // swapping hands the oldest frame's vectors back to m_current, so recording stops allocating once the ring is full
+    std::swap(profiler.m_history[profiler.m_next], frame);
+    profiler.m_next = (profiler.m_next + 1) % PROFILER_HISTORY_SIZE;
+    profiler.m_size = std::min(profiler.m_size + 1, PROFILER_HISTORY_SIZE);
+}
+
+void drawNodeProfiled(DrawGridAPIImpl& impl, size_t index, VertexBuffers& buffers, float minX, float maxX, float minY, float maxY) {
+    DrawNode* drawNode = impl.m_drawNodes[index].get();
+    growBoundsForNode(impl, *drawNode, minX, maxX, minY, maxY);
+    const bool scheduled = impl.m_scheduler.m_budgetMs > 0;
+    if (!impl.m_profiler.m_enabled && !impl.m_trace.m_enabled && !scheduled) {
+        DrawLoopAllocationScope allocations;
+        drawNode->draw(impl.m_drawGridLayer, minX, maxX, minY, maxY);
+        return;
+    }
+
+    const size_t primitivesBefore = buffers.primitiveCount();
+    const size_t callbacksBefore = drawNode->getCallbackCount();
+    // thread safe nodes can't queue render thread work, and may be running on a worker where this would race
+    const size_t customDrawsBefore = drawNode->isThreadSafe() ? 0 : impl.m_customDraws.size();
+    const auto start = std::chrono::steady_clock::now();
+
+    {
+        DrawLoopAllocationScope allocations;
+        drawNode->draw(impl.m_drawGridLayer, minX, maxX, minY, maxY);
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+    const std::chrono::duration<float, std::milli> elapsed = end - start;
+    const auto primitives = static_cast<uint32_t>(buffers.primitiveCount() - primitivesBefore);
+    const auto callbacks = static_cast<uint32_t>(drawNode->getCallbackCount() - callbacksBefore);
+
+    if (scheduled) {
+        recordNodeCost(impl, *drawNode, elapsed.count(), !drawNode->isThreadSafe() && impl.m_customDraws.size() != customDrawsBefore);
+    }
+
+    if (impl.m_profiler.m_enabled) {
+        auto& stats = impl.m_profiler.m_current.nodes[index];
+        stats.id = drawNode->getIDRef();
+        stats.cpuMs = elapsed.count();
+        stats.primitives = primitives;
+        stats.callbacks = callbacks;
+    }
+
+    // a span per callback call would flood the trace, so they're counted on the node's span instead
+    if (impl.m_trace.m_enabled) {
+        recordTraceEvent(impl, "node", drawNode->getIDRef(), start, end, fmt::format("\"primitives\":{},\"callbacks\":{}", primitives, callbacks));
+    }
+}
+
+void recordDrawCall(DrawGridAPIImpl& impl, DrawGridAPI::DrawMode drawMode, PrimitiveKind kind, float width, size_t vertices) {
+    auto& frame = impl.m_profiler.m_current;
+    ++frame.drawCalls;
+    frame.buckets.push_back({drawMode, kind, width, static_cast<uint32_t>(vertices)});
+}
+
+void DrawGridAPI::setProfiling(bool enabled) {
+    m_impl->m_profiler.m_enabled = enabled;
+}
+
+bool DrawGridAPI::isProfiling() {
+    return m_impl->m_profiler.m_enabled;
+}
+
+std::vector<DrawGridAPI::ProfilerFrame> DrawGridAPI::getProfilerHistory() {
+    const auto& profiler = m_impl->m_profiler;
+    std::vector<ProfilerFrame> history;
+    history.reserve(profiler.m_size);
+
+    const size_t oldest = (profiler.m_next + PROFILER_HISTORY_SIZE - profiler.m_size) % PROFILER_HISTORY_SIZE;
+    for (size_t i = 0; i < profiler.m_size; ++i) {
+        history.push_back(profiler.m_history[(oldest + i) % PROFILER_HISTORY_SIZE]);
+    }
+    return history;
+}
+
+DrawGridAPI::ProfilerSummary DrawGridAPI::getProfilerSummary() {
+    const auto history = getProfilerHistory();
+    ProfilerSummary summary;
+    summary.frames = history.size();
+    if (history.empty()) return summary;
+
+    struct NodeSamples {
+        std::vector<float> cpuMs;
+        size_t primitives = 0;
+        size_t callbacks = 0;
+    };
+
+    std::vector<float> frameMs;
+    std::vector<float> gpuMs;
+    std::vector<std::string> order;
+    std::unordered_map<std::string, NodeSamples> samples;
+    size_t drawCalls = 0;
+    size_t vertices = 0;
+
+    for (const auto& frame : history) {
+        frameMs.push_back(frame.totalMs);
+        if (frame.gpuMs >= 0) gpuMs.push_back(frame.gpuMs);
+        drawCalls += frame.drawCalls;
+        for (const auto& bucket : frame.buckets) vertices += bucket.vertices;
+
+        for (const auto& node : frame.nodes) {
+            auto [it, inserted] = samples.try_emplace(node.id);
+            if (inserted) order.push_back(node.id);
+            it->second.cpuMs.push_back(node.cpuMs);
+            it->second.primitives += node.primitives;
+            it->second.callbacks += node.callbacks;
+        }
+    }
+
+    const float frames = static_cast<float>(history.size());
+    summary.averageFrameMs = std::accumulate(frameMs.begin(), frameMs.end(), 0.f) / frames;
+    summary.p99FrameMs = percentile99(frameMs);
+    if (!gpuMs.empty()) {
+        summary.averageGPUMs = std::accumulate(gpuMs.begin(), gpuMs.end(), 0.f) / gpuMs.size();
+        summary.p99GPUMs = percentile99(gpuMs);
+    }
+    summary.averageDrawCalls = drawCalls / frames;
+    summary.averageVertices = vertices / frames;
+
+    for (const auto& id : order) {
+        auto& node = samples[id];
+        const float count = static_cast<float>(node.cpuMs.size());
+        summary.nodes.push_back({
+            id,
+            std::accumulate(node.cpuMs.begin(), node.cpuMs.end(), 0.f) / count,
+            percentile99(node.cpuMs),
+            node.primitives / count,
+            node.callbacks / count
+        });
+    }
+    return summary;
+}
+
+void DrawGridAPI::clearProfilerHistory() {
+    auto& profiler = m_impl->m_profiler;
+    profiler.m_history.clear();
+    profiler.m_next = 0;
+    profiler.m_size = 0;
+}
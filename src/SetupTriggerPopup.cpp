@@ -0,0 +1,24 @@
+#include <Geode/Geode.hpp>
+#include <Geode/modify/SetupTriggerPopup.hpp>
+#include "../include/DrawGridAPI.hpp"
+
+using namespace geode::prelude;
+
+class $modify(MySetupTriggerPopup, SetupTriggerPopup) {
+
+    // durations and spawn or touch triggered are only changed from here, some of it only once the popup closes
+    void onClose(CCObject* p0) {
+        // closing can release the popup, so hold onto what it was editing
+        Ref<EffectGameObject> object = m_gameObject;
+        Ref<CCArray> objects = m_gameObjects;
+        SetupTriggerPopup::onClose(p0);
+
+        auto& api = DrawGridAPI::get();
+        if (object) api.updateTrigger(object);
+        if (objects) {
+            for (auto obj : CCArrayExt<GameObject*>(objects)) {
+                api.updateTrigger(obj);
+            }
+        }
+    }
+};
@@ -0,0 +1,241 @@
+#include "../include/DrawGridAPI.hpp"
+#include "DrawGridAPIImpl.hpp"
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include <Geode/Geode.hpp>
+
+using namespace geode::prelude;
+
+static void mix(uint64_t& hash, uint64_t value) {
+    hash = (hash ^ value) * 0x100000001b3ull;
+}
+
+static uint64_t floatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static uint64_t countOf(CCArray* array) {
+    return array ? array->count() : 0;
+}
+
+/*
+    There's nothing telling the grid when the level changes, so this stands in for it. Every edit goes
+    through the undo stack, adding or removing objects changes the counts, moving a trigger bumps its
+    table's generation, and selecting an object can show its effect line while it's hidden. Anything else
+    has to call invalidateStaticCache.
+*/
+static uint64_t contentFingerprint(const DrawGridAPIImpl& impl) {
+    auto dgl = impl.m_drawGridLayer;
+    auto editorLayer = dgl->m_editorLayer;
+    auto editorUI = editorLayer->m_editorUI;
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    for (const auto& drawNode : impl.m_drawNodes) {
+        if (drawNode->isEnabled() && drawNode->isCacheable()) mix(hash, reinterpret_cast<uintptr_t>(drawNode.get()));
+    }
+
+    mix(hash, floatBits(dgl->m_gridSize));
+    mix(hash, floatBits(impl.m_gridWidthMin));
+    mix(hash, floatBits(impl.m_gridWidthMax));
+    mix(hash, floatBits(impl.m_gridHeightMin));
+    mix(hash, floatBits(levelHeight(impl)));
+    mix(hash, impl.m_invertGrid);
+    mix(hash, impl.m_hideInvisible);
+    mix(hash, static_cast<uint64_t>(impl.m_columnAggregation));
+    mix(hash, impl.m_level->m_timeMarkersGeneration);
+    mix(hash, impl.m_level->m_effectTriggers.m_table.generation);
+    mix(hash, impl.m_level->m_guideTriggers.m_table.generation);
+
+    mix(hash, editorLayer->m_showGrid);
+    mix(hash, editorLayer->m_hideGridOnPlay);
+    mix(hash, editorLayer->m_drawEffectLines);
+    mix(hash, static_cast<uint64_t>(editorLayer->m_playbackMode));
+    mix(hash, static_cast<uint64_t>(editorLayer->m_currentLayer));
+    mix(hash, countOf(editorLayer->m_objects));
+    mix(hash, countOf(editorLayer->m_undoObjects));
+    mix(hash, countOf(editorLayer->m_redoObjects));
+    mix(hash, countOf(dgl->m_effectGameObjects));
+    mix(hash, reinterpret_cast<uintptr_t>(editorUI->m_selectedObject));
+    mix(hash, countOf(editorUI->m_selectedObjects));
+    return hash;
+}
+
+static bool hasUncacheableGeometry(VertexBuffers& buffers) {
+    for (auto drawMode : {DrawGridAPI::DrawMode::BLEND, DrawGridAPI::DrawMode::INVERT}) {
+        for (const auto& [_, vertices] : buffers.lineBuckets(drawMode)) {
+            if (!vertices.empty()) return true;
+        }
+        if (!buffers.rects(drawMode).empty() || !buffers.rectOutlines(drawMode).empty()) return true;
+    }
+    return false;
+}
+
+/*
+    The texture is drawn at the screen's resolution with the view's zoom and rotation, so while only panning
+    it can be drawn shifted instead of drawing the layers again. Normal mode blends the same way into an empty
+    texture as onto the screen, so drawing the texture over the screen gives the same colors.
+*/
+static bool renderStaticCache(DrawGridAPIImpl& impl, const ViewCamera& camera) {
+    auto& cache = impl.m_staticCache;
+    const CCSize winSize = CCDirector::get()->getWinSize();
+
+    ViewCamera cacheCamera = camera;
+    cacheCamera.m_size = {
+        std::ceil(camera.m_size.width * (1 + cache.m_margin * 2)),
+        std::ceil(camera.m_size.height * (1 + cache.m_margin * 2))
+    };
+    const ViewPolygon polygon = computeViewPolygon(cacheCamera);
+    const CCRect bounds = viewBounds(impl, polygon);
+
+    // the nodes cull and clip against the view they're drawn for
+    const ViewPolygon framePolygon = std::exchange(impl.m_viewPolygon, polygon);
+    const CCRect frameRect = std::exchange(impl.m_visibleRect, bounds);
+    {
+        TargetBuffersScope scope(&cache.m_buffers);
+        for (size_t i = 0; i < impl.m_drawNodes.size(); ++i) {
+            const DrawNode& drawNode = *impl.m_drawNodes[i];
+            if (!drawNode.isEnabled() || !drawNode.isCacheable()) continue;
+            drawNodeProfiled(impl, i, cache.m_buffers, bounds.getMinX(), bounds.getMaxX(), bounds.getMinY(), bounds.getMaxY());
+        }
+    }
+    impl.m_viewPolygon = framePolygon;
+    impl.m_visibleRect = frameRect;
+
+    if (hasUncacheableGeometry(cache.m_buffers)) {
+        cache.m_unsupported = true;
+        cache.m_buffers.reset();
+        return false;
+    }
+
+    const int width = static_cast<int>(cacheCamera.m_size.width);
+    const int height = static_cast<int>(cacheCamera.m_size.height);
+    if (!cache.m_texture || cache.m_camera.m_size.width != cacheCamera.m_size.width || cache.m_camera.m_size.height != cacheCamera.m_size.height) {
+        cache.m_texture = CCRenderTexture::create(width, height);
+        if (!cache.m_texture) {
+            cache.m_buffers.reset();
+            return false;
+        }
+        // it's only ever drawn shifted and never scaled, so lines stay sharp and snap to the closest pixel
+        cache.m_texture->getSprite()->getTexture()->setAliasTexParameters();
+    }
+
+    const bool gpuTimersActive = std::exchange(impl.m_gpuTimers.m_active, false);
+    cache.m_texture->beginWithClear(0, 0, 0, 0);
+
+    // the render texture maps the window onto itself, so squeeze the cached view into the window
+    kmGLMatrixMode(KM_GL_MODELVIEW);
+    kmGLPushMatrix();
+    kmGLLoadIdentity();
+    kmGLScalef(winSize.width / cacheCamera.m_size.width, winSize.height / cacheCamera.m_size.height, 1);
+    kmGLTranslatef(cacheCamera.m_size.width * 0.5f, cacheCamera.m_size.height * 0.5f, 0);
+    kmGLRotatef(camera.m_angle, 0, 0, 1);
+    kmGLScalef(camera.m_scale, camera.m_scale, 1);
+    kmGLTranslatef(-camera.m_center.x, -camera.m_center.y, 0);
+
+    impl.m_shader->use();
+    impl.m_shader->setUniformsForBuiltins();
+    ccGLEnableVertexAttribs(kCCVertexAttribFlag_Position | kCCVertexAttribFlag_Color);
+    submitBuffers(impl, cache.m_buffers, 0, false);
+    glLineWidth(1);
+
+    kmGLPopMatrix();
+    cache.m_texture->end();
+    impl.m_gpuTimers.m_active = gpuTimersActive;
+
+    cache.m_buffers.reset();
+    cache.m_camera = cacheCamera;
+    cache.m_corners = polygon.corners;
+    cache.m_dirty = false;
+    ++cache.m_stats.renders;
+    return true;
+}
+
+void updateStaticCache(DrawGridAPIImpl& impl, const ViewCamera& camera) {
+    auto& cache = impl.m_staticCache;
+    cache.m_active = false;
+
+    // pipelined batches lag a frame behind the texture, and smoothed lines blend with what's under them
+    const bool smoothing = impl.m_lineSmoothing && camera.m_scale >= impl.m_lineSmoothingLimit;
+    if (!cache.m_enabled || impl.m_pipelinedDraw || smoothing) return;
+
+    TraceScope trace(impl, "view", "updateStaticCache");
+    const StaticCacheKey key = {camera.m_scale, camera.m_angle, camera.m_size, contentFingerprint(impl)};
+    if (!(key == cache.m_key)) {
+        cache.m_key = key;
+        cache.m_dirty = true;
+        cache.m_unsupported = false;
+    }
+    if (cache.m_unsupported) return;
+
+    if (cache.m_dirty || !viewContains(cache.m_camera, camera)) {
+        if (!renderStaticCache(impl, camera)) return;
+    }
+    else {
+        ++cache.m_stats.hits;
+    }
+    cache.m_active = true;
+}
+
+void drawStaticCache(DrawGridAPIImpl& impl) {
+    auto& cache = impl.m_staticCache;
+    if (!cache.m_active) return;
+
+    TraceScope trace(impl, "batch", "drawStaticCache");
+    const auto& corners = cache.m_corners;
+    const GLfloat positions[] = {
+        corners[0].x, corners[0].y,
+        corners[1].x, corners[1].y,
+        corners[3].x, corners[3].y,
+        corners[2].x, corners[2].y
+    };
+    static constexpr GLfloat texCoords[] = {0, 0, 1, 0, 0, 1, 1, 1};
+
+    auto program = CCShaderCache::sharedShaderCache()->programForKey(kCCShader_PositionTexture);
+    program->use();
+    program->setUniformsForBuiltins();
+    ccGLEnableVertexAttribs(kCCVertexAttribFlag_Position | kCCVertexAttribFlag_TexCoords);
+    ccGLBindTexture2D(cache.m_texture->getSprite()->getTexture()->getName());
+    ccGLBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glVertexAttribPointer(kCCVertexAttrib_Position, 2, GL_FLOAT, GL_FALSE, 0, positions);
+    glVertexAttribPointer(kCCVertexAttrib_TexCoords, 2, GL_FLOAT, GL_FALSE, 0, texCoords);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+    impl.m_shader->use();
+    impl.m_shader->setUniformsForBuiltins();
+    ccGLEnableVertexAttribs(kCCVertexAttribFlag_Position | kCCVertexAttribFlag_Color);
+}
+
+bool drawnFromStaticCache(const DrawGridAPIImpl& impl, const DrawNode& drawNode) {
+    return impl.m_staticCache.m_active && drawNode.isCacheable();
+}
+
+void DrawGridAPI::setStaticCache(bool enabled) {
+    auto& cache = m_impl->m_staticCache;
+    cache.m_enabled = enabled;
+    cache.m_dirty = true;
+    if (!enabled) cache.m_texture = nullptr;
+}
+
+bool DrawGridAPI::isStaticCache() {
+    return m_impl->m_staticCache.m_enabled;
+}
+
+void DrawGridAPI::setStaticCacheMargin(float fraction) {
+    m_impl->m_staticCache.m_margin = std::max(fraction, 0.f);
+    m_impl->m_staticCache.m_dirty = true;
+}
+
+float DrawGridAPI::getStaticCacheMargin() {
+    return m_impl->m_staticCache.m_margin;
+}
+
+void DrawGridAPI::invalidateStaticCache() {
+    m_impl->m_staticCache.m_dirty = true;
+}
+
+DrawGridAPI::StaticCacheStats DrawGridAPI::getStaticCacheStats() {
+    return m_impl->m_staticCache.m_stats;
+}
@@ -0,0 +1,108 @@
+#include "../include/DrawGridAPI.hpp"
+#include "DrawGridAPIImpl.hpp"
+#include <fstream>
+#include <Geode/Geode.hpp>
+
+using namespace geode::prelude;
+
+static void appendEscaped(std::string& out, const std::string& text) {
+    for (char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) out += fmt::format("\\u{:04x}", static_cast<int>(c));
+                else out += c;
+        }
+    }
+}
+
+void recordTraceEvent(DrawGridAPIImpl& impl, const char* category, std::string name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end, std::string args) {
+    auto& trace = impl.m_trace;
+    std::lock_guard lock(trace.m_mutex);
+    if (!trace.m_enabled || trace.m_capacity == 0) return;
+
+    auto [it, _] = trace.m_threads.try_emplace(std::this_thread::get_id(), static_cast<uint32_t>(trace.m_threads.size()));
+
+    const std::chrono::duration<double, std::micro> startUs = start - trace.m_origin;
+    const std::chrono::duration<double, std::micro> durationUs = end - start;
+
+    auto& event = trace.m_events[trace.m_next];
+    event.m_name = std::move(name);
+    event.m_category = category;
+    event.m_start = startUs.count();
+    event.m_duration = durationUs.count();
+    event.m_thread = it->second;
+    event.m_args = std::move(args);
+
+    trace.m_next = (trace.m_next + 1) % trace.m_capacity;
+    trace.m_size = std::min(trace.m_size + 1, trace.m_capacity);
+}
+
+void DrawGridAPI::startTrace(size_t maxEvents) {
+    auto& trace = m_impl->m_trace;
+    std::lock_guard lock(trace.m_mutex);
+    trace.m_events.clear();
+    trace.m_events.resize(maxEvents);
+    trace.m_capacity = maxEvents;
+    trace.m_next = 0;
+    trace.m_size = 0;
+    trace.m_threads.clear();
+    // whoever starts the trace is on the main thread, which is also the one drawing
+    trace.m_threads.emplace(std::this_thread::get_id(), 0);
+    trace.m_origin = std::chrono::steady_clock::now();
+    trace.m_enabled = true;
+}
+
+bool DrawGridAPI::isTracing() {
+    return m_impl->m_trace.m_enabled;
+}
+
+Result<std::filesystem::path> DrawGridAPI::stopTrace(std::filesystem::path path) {
+    auto& trace = m_impl->m_trace;
+    std::lock_guard lock(trace.m_mutex);
+    if (!trace.m_enabled) return Err("No trace is running");
+    trace.m_enabled = false;
+
+    if (path.empty()) {
+        const auto now = std::chrono::system_clock::now().time_since_epoch();
+        path = Mod::get()->getSaveDir() / fmt::format("trace-{}.json", std::chrono::duration_cast<std::chrono::seconds>(now).count());
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) return Err("Could not open trace file for writing");
+
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    for (const auto& [thread, id] : trace.m_threads) {
+        out += fmt::format("{{\"ph\":\"M\",\"pid\":1,\"tid\":{},\"name\":\"thread_name\",\"args\":{{\"name\":\"{}\"}}}}", id, id == 0 ? "main" : fmt::format("worker {}", id));
+        out += ",\n";
+    }
+
+    const size_t oldest = (trace.m_next + trace.m_capacity - trace.m_size) % std::max<size_t>(trace.m_capacity, 1);
+    for (size_t i = 0; i < trace.m_size; ++i) {
+        const auto& event = trace.m_events[(oldest + i) % trace.m_capacity];
+        out += "{\"ph\":\"X\",\"pid\":1,\"name\":\"";
+        appendEscaped(out, event.m_name);
+        out += fmt::format("\",\"cat\":\"{}\",\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f},\"args\":{{{}}}}}", event.m_category, event.m_thread, event.m_start, event.m_duration, event.m_args);
+        out += ",\n";
+
+        // flush in chunks so a full buffer doesn't need one huge string
+        if (out.size() > (1 << 20)) {
+            file << out;
+            out.clear();
+        }
+    }
+    // ending on the process name means every event above can end with a comma
+    out += "{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"Good Grid\"}}\n]}\n";
+    file << out;
+
+    trace.m_events.clear();
+    trace.m_events.shrink_to_fit();
+    trace.m_capacity = 0;
+    trace.m_size = 0;
+    trace.m_next = 0;
+
+    if (!file) return Err("Could not write trace file");
+    return Ok(path);
+}
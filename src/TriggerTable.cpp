@@ -0,0 +1,107 @@
+#include "../include/DrawGridAPI.hpp"
+#include "DrawGridAPIImpl.hpp"
+#include <Geode/Geode.hpp>
+
+using namespace geode::prelude;
+
+static float triggerDuration(EffectGameObject* obj) {
+    if (obj->m_objectID == 1006) {
+        return obj->m_fadeInDuration + obj->m_holdDuration + obj->m_fadeOutDuration;
+    }
+    if (obj->m_objectID == 3602) {
+        return static_cast<SFXTriggerGameObject*>(obj)->m_soundDuration;
+    }
+    return obj->m_duration;
+}
+
+static void fillRow(TriggerTableState& state, size_t row, GameObject* object) {
+    auto& table = state.m_table;
+    table.x[row] = object->getPositionX();
+    table.y[row] = object->getPositionY();
+
+    // guide objects aren't all effect objects
+    if (state.m_guides) {
+        table.portalRanges[row] = DrawGridAPI::get().getPortalMinMax(object);
+        return;
+    }
+    auto obj = static_cast<EffectGameObject*>(object);
+    table.flags[row] = (obj->m_isSpawnTriggered ? TriggerTable::SPAWN_TRIGGERED : 0) | (obj->m_isTouchTriggered ? TriggerTable::TOUCH_TRIGGERED : 0);
+    table.durations[row] = triggerDuration(obj);
+}
+
+static void rebuildTable(TriggerTableState& state, CCArray* source) {
+    auto& table = state.m_table;
+    const size_t count = source ? source->count() : 0;
+
+    table.objects.resize(count);
+    table.x.resize(count);
+    table.y.resize(count);
+    table.flags.assign(count, 0);
+    if (state.m_guides) table.portalRanges.resize(count);
+    else table.durations.resize(count);
+
+    state.m_rows.clear();
+    state.m_rows.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        auto object = static_cast<GameObject*>(source->objectAtIndex(i));
+        table.objects[i] = object;
+        state.m_rows[object] = static_cast<uint32_t>(i);
+        fillRow(state, i, object);
+    }
+
+    ++table.generation;
+    state.m_source = source;
+    state.m_dirty = false;
+}
+
+/*
+    Moves and trigger settings update their rows through the hooks as they happen, so a table only has to be
+    read again after something the hooks can't follow one object at a time, like adding, removing or undoing.
+*/
+static void syncTable(TriggerTableState& state, CCArray* source) {
+    const size_t count = source ? source->count() : 0;
+    if (state.m_dirty || state.m_source != source || state.m_table.size() != count) rebuildTable(state, source);
+}
+
+void syncTriggerTables(DrawGridAPIImpl& impl) {
+    TraceScope trace(impl, "view", "syncTriggerTables");
+    auto dgl = impl.m_drawGridLayer;
+    auto& level = *impl.m_level;
+    syncTable(level.m_effectTriggers, dgl->m_effectGameObjects);
+    syncTable(level.m_durationTriggers, dgl->m_editorLayer->m_durationObjects);
+    syncTable(level.m_guideTriggers, dgl->m_guideObjects);
+}
+
+const TriggerTable& DrawGridAPI::getEffectTriggers() {
+    return m_impl->m_level->m_effectTriggers.m_table;
+}
+
+const TriggerTable& DrawGridAPI::getDurationTriggers() {
+    return m_impl->m_level->m_durationTriggers.m_table;
+}
+
+const TriggerTable& DrawGridAPI::getGuideTriggers() {
+    return m_impl->m_level->m_guideTriggers.m_table;
+}
+
+void DrawGridAPI::invalidateTriggerTables() {
+    auto& level = *m_impl->m_level;
+    for (auto state : {&level.m_effectTriggers, &level.m_durationTriggers, &level.m_guideTriggers}) {
+        state->m_dirty = true;
+    }
+}
+
+void DrawGridAPI::updateTrigger(GameObject* object) {
+    // until the next editor draws, the tables still point into the last one
+    auto editorLayer = LevelEditorLayer::get();
+    if (!editorLayer || editorLayer->m_drawGridLayer != m_impl->m_drawGridLayer) return;
+
+    auto& level = *m_impl->m_level;
+    for (auto state : {&level.m_effectTriggers, &level.m_durationTriggers, &level.m_guideTriggers}) {
+        if (state->m_dirty) continue;
+        auto it = state->m_rows.find(object);
+        if (it == state->m_rows.end()) continue;
+        fillRow(*state, it->second, object);
+        ++state->m_table.generation;
+    }
+}
@@ -0,0 +1,191 @@
+#include "../include/DrawGridAPI.hpp"
+#include "DrawGridAPIImpl.hpp"
+#include <cmath>
+#include <cstring>
+#include <Geode/Geode.hpp>
+
+using namespace geode::prelude;
+
+// what the view is grown by, so lines sitting right on the edge of the screen keep their full width
+static constexpr float CULL_MARGIN_PIXELS = 4.f;
+
+static ccColor4B lerpColor(const ccColor4B& a, const ccColor4B& b, float t) {
+    return {
+        static_cast<GLubyte>(a.r + (b.r - a.r) * t + 0.5f),
+        static_cast<GLubyte>(a.g + (b.g - a.g) * t + 0.5f),
+        static_cast<GLubyte>(a.b + (b.b - a.b) * t + 0.5f),
+        static_cast<GLubyte>(a.a + (b.a - a.a) * t + 0.5f)
+    };
+}
+
+// Cyrus-Beck, the view is always convex
+static bool clipRange(const ViewPolygon& polygon, const ccVertex2F& start, const ccVertex2F& end, float margin, float& t0, float& t1) {
+    const float dx = end.x - start.x;
+    const float dy = end.y - start.y;
+    t0 = 0;
+    t1 = 1;
+
+    for (size_t i = 0; i < polygon.corners.size(); ++i) {
+        const CCPoint& normal = polygon.normals[i];
+        const CCPoint& corner = polygon.corners[i];
+        const float distance = margin - (normal.x * (start.x - corner.x) + normal.y * (start.y - corner.y));
+        const float along = normal.x * dx + normal.y * dy;
+
+        if (along == 0) {
+            if (distance < 0) return false;
+            continue;
+        }
+        const float t = distance / along;
+        if (along > 0) t1 = std::min(t1, t);
+        else t0 = std::max(t0, t);
+        if (t0 > t1) return false;
+    }
+    return true;
+}
+
+CCRect ViewPolygon::getBounds(float margin) const {
+    float minX = corners[0].x, maxX = corners[0].x;
+    float minY = corners[0].y, maxY = corners[0].y;
+    for (const auto& corner : corners) {
+        minX = std::min(minX, corner.x);
+        maxX = std::max(maxX, corner.x);
+        minY = std::min(minY, corner.y);
+        maxY = std::max(maxY, corner.y);
+    }
+    return {minX - margin, minY - margin, maxX - minX + margin * 2, maxY - minY + margin * 2};
+}
+
+bool ViewPolygon::clipLine(ccVertex2F& start, ccVertex2F& end, float margin) const {
+    float t0, t1;
+    if (!clipRange(*this, start, end, margin, t0, t1)) return false;
+
+    const ccVertex2F from = start;
+    const float dx = end.x - from.x;
+    const float dy = end.y - from.y;
+    if (t0 > 0) start = {from.x + dx * t0, from.y + dy * t0};
+    if (t1 < 1) end = {from.x + dx * t1, from.y + dy * t1};
+    return true;
+}
+
+bool ViewPolygon::clipLine(ccVertex2F& start, ccVertex2F& end, ccColor4B& colorA, ccColor4B& colorB, float width) const {
+    float t0, t1;
+    if (!clipRange(*this, start, end, (width * 0.5f + CULL_MARGIN_PIXELS) * unitsPerPixel, t0, t1)) return false;
+    if (t0 == 0 && t1 == 1) return true;
+
+    const ccVertex2F from = start;
+    const float dx = end.x - from.x;
+    const float dy = end.y - from.y;
+    start = {from.x + dx * t0, from.y + dy * t0};
+    end = {from.x + dx * t1, from.y + dy * t1};
+
+    if (std::memcmp(&colorA, &colorB, sizeof(ccColor4B)) != 0) {
+        const ccColor4B original = colorA;
+        colorA = lerpColor(original, colorB, t0);
+        colorB = lerpColor(original, colorB, t1);
+    }
+    return true;
+}
+
+ViewCamera currentCamera(const DrawGridAPIImpl& impl) {
+    const auto& view = impl.m_view;
+    if (view.m_enabled) return {view.m_center, view.m_viewport.size, view.m_scale, view.m_angle};
+
+    const auto editorLayer = impl.m_drawGridLayer->m_editorLayer;
+    const CCSize winSize = CCDirector::get()->getWinSize();
+    return {
+        editorLayer->m_objectLayer->convertToNodeSpace({winSize.width * 0.5f, winSize.height * 0.5f}),
+        winSize,
+        editorLayer->m_objectLayer->getScale(),
+        editorLayer->m_gameState.m_cameraAngle
+    };
+}
+
+/*
+    The editor turns the whole view around the middle of the screen, outside of the object layer's own
+    transform, so the corners are turned here the same way PositionLines finds its lines.
+*/
+ViewPolygon computeViewPolygon(const ViewCamera& camera) {
+    const CCSize winSize = CCDirector::get()->getWinSize();
+    const CCSize winSizeInPixels = CCDirector::get()->getWinSizeInPixels();
+    const CCPoint& center = camera.m_center;
+    const float scale = camera.m_scale;
+    const float angle = camera.m_angle;
+    const float halfWidth = camera.m_size.width * 0.5f / scale;
+    const float halfHeight = camera.m_size.height * 0.5f / scale;
+    const float angleRad = -CC_DEGREES_TO_RADIANS(angle);
+    const float sinAngle = std::sin(angleRad);
+    const float cosAngle = std::cos(angleRad);
+
+    const CCPoint offsets[] = {{-halfWidth, -halfHeight}, {halfWidth, -halfHeight}, {halfWidth, halfHeight}, {-halfWidth, halfHeight}};
+
+    ViewPolygon polygon;
+    for (size_t i = 0; i < polygon.corners.size(); ++i) {
+        polygon.corners[i] = {
+            center.x + cosAngle * offsets[i].x - sinAngle * offsets[i].y,
+            center.y + sinAngle * offsets[i].x + cosAngle * offsets[i].y
+        };
+    }
+    for (size_t i = 0; i < polygon.corners.size(); ++i) {
+        const CCPoint edge = polygon.corners[(i + 1) % polygon.corners.size()] - polygon.corners[i];
+        const float length = std::sqrt(edge.x * edge.x + edge.y * edge.y);
+        polygon.normals[i] = {edge.y / length, -edge.x / length};
+    }
+
+    polygon.unitsPerPixel = winSize.width / (winSizeInPixels.width * scale);
+    polygon.rotated = std::fmod(angle, 90.f) != 0;
+    return polygon;
+}
+
+bool viewContains(const ViewCamera& outer, const ViewCamera& inner) {
+    const float angleRad = -CC_DEGREES_TO_RADIANS(inner.m_angle);
+    const float sinAngle = std::sin(angleRad);
+    const float cosAngle = std::cos(angleRad);
+    const float dx = inner.m_center.x - outer.m_center.x;
+    const float dy = inner.m_center.y - outer.m_center.y;
+    // the offset in screen points, undoing the turn computeViewPolygon does
+    const float offsetX = (cosAngle * dx + sinAngle * dy) * inner.m_scale;
+    const float offsetY = (cosAngle * dy - sinAngle * dx) * inner.m_scale;
+
+    return std::abs(offsetX) * 2 + inner.m_size.width <= outer.m_size.width
+        && std::abs(offsetY) * 2 + inner.m_size.height <= outer.m_size.height;
+}
+
+float levelHeight(const DrawGridAPIImpl& impl) {
+    return impl.m_drawGridLayer->m_editorLayer->m_levelSettings->m_dynamicLevelHeight ? impl.m_gridHeightMax : MAX_HEIGHT;
+}
+
+CCRect viewBounds(const DrawGridAPIImpl& impl, const ViewPolygon& polygon) {
+    const CCRect bounds = polygon.getBounds(CULL_MARGIN_PIXELS * polygon.unitsPerPixel);
+    const float minX = std::max(bounds.getMinX(), impl.m_gridWidthMin);
+    const float maxX = std::min(bounds.getMaxX(), impl.m_gridWidthMax);
+    const float minY = std::max(bounds.getMinY(), impl.m_gridHeightMin);
+    const float maxY = std::min(bounds.getMaxY(), levelHeight(impl));
+    return {minX, minY, maxX - minX, maxY - minY};
+}
+
+void growBoundsForNode(const DrawGridAPIImpl& impl, const DrawNode& drawNode, float& minX, float& maxX, float& minY, float& maxY) {
+    const float margin = drawNode.getCullingMargin();
+    if (margin == 0) return;
+
+    // the bounds are already clamped to the grid, growing them and clamping again is the same as clamping once
+    minX = std::max(minX - margin, impl.m_gridWidthMin);
+    maxX = std::min(maxX + margin, impl.m_gridWidthMax);
+    minY = std::max(minY - margin, impl.m_gridHeightMin);
+    maxY = std::min(maxY + margin, levelHeight(impl));
+}
+
+void clipLineRun(const ViewPolygon& polygon, std::vector<Vertex>& buffer, size_t offset, float width) {
+    size_t kept = offset;
+    for (size_t i = offset; i + 1 < buffer.size(); i += 2) {
+        Vertex start = buffer[i];
+        Vertex end = buffer[i + 1];
+        if (!polygon.clipLine(start.position, end.position, start.color, end.color, width)) continue;
+        buffer[kept++] = start;
+        buffer[kept++] = end;
+    }
+    buffer.resize(kept);
+}
+
+const ViewPolygon& DrawGridAPI::getViewPolygon() {
+    return m_impl->m_viewPolygon;
+}
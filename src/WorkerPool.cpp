@@ -0,0 +1,85 @@
+#include "WorkerPool.hpp"
+#include <Geode/Geode.hpp>
+
+using namespace geode::prelude;
+
+WorkerPool::WorkerPool(size_t threadCount) : m_state(std::make_shared<State>()) {
+    m_threads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_threads.emplace_back(&WorkerPool::workerLoop, m_state);
+    }
+}
+
+/*
+    The workers only hold onto the shared state, so they can be detached instead of joined. Joining here
+    could deadlock when the pool gets destroyed while the mod is unloading on Windows (loader lock).
+*/
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard lock(m_state->m_mutex);
+        m_state->m_stopping = true;
+    }
+    m_state->m_jobAvailable.notify_all();
+    for (auto& thread : m_threads) {
+        if (thread.joinable()) thread.detach();
+    }
+}
+
+size_t WorkerPool::defaultThreadCount() {
+    const size_t hardware = std::thread::hardware_concurrency();
+    // leave the render thread its own core, it runs the nodes that aren't thread safe meanwhile
+    return std::clamp<size_t>(hardware > 1 ? hardware - 1 : 1, 1, 4);
+}
+
+void WorkerPool::workerLoop(std::shared_ptr<State> state) {
+    // counts the job as done however it ends, so wait() can't hang on one that threw
+    struct FinishedJobGuard {
+        State& m_state;
+
+        ~FinishedJobGuard() {
+            {
+                std::lock_guard lock(m_state.m_mutex);
+                --m_state.m_pending;
+            }
+            m_state.m_jobsDone.notify_all();
+        }
+    };
+
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock lock(state->m_mutex);
+            state->m_jobAvailable.wait(lock, [&] { return state->m_stopping || !state->m_jobs.empty(); });
+            if (state->m_stopping) return;
+            job = std::move(state->m_jobs.front());
+            state->m_jobs.pop_front();
+        }
+
+        FinishedJobGuard finished{*state};
+        try {
+            job();
+        } catch (const std::exception& e) {
+            log::error("Draw job failed: {}", e.what());
+        } catch (...) {
+            log::error("Draw job failed");
+        }
+    }
+}
+
+void WorkerPool::submit(std::function<void()> job) {
+    {
+        std::lock_guard lock(m_state->m_mutex);
+        m_state->m_jobs.push_back(std::move(job));
+        ++m_state->m_pending;
+    }
+    m_state->m_jobAvailable.notify_one();
+}
+
+void WorkerPool::wait() {
+    std::unique_lock lock(m_state->m_mutex);
+    m_state->m_jobsDone.wait(lock, [&] { return m_state->m_pending == 0; });
+}
+
+size_t WorkerPool::size() const {
+    return m_threads.size();
+}
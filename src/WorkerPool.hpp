@@ -0,0 +1,39 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <deque>
+
+// a small fixed size pool for running draw jobs off the render thread
+class WorkerPool {
+    struct State {
+        std::mutex m_mutex;
+        std::condition_variable m_jobAvailable;
+        std::condition_variable m_jobsDone;
+        std::deque<std::function<void()>> m_jobs;
+        size_t m_pending = 0;
+        bool m_stopping = false;
+    };
+
+    std::shared_ptr<State> m_state;
+    std::vector<std::thread> m_threads;
+
+    static void workerLoop(std::shared_ptr<State> state);
+
+public:
+    explicit WorkerPool(size_t threadCount);
+    ~WorkerPool();
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    static size_t defaultThreadCount();
+
+    void submit(std::function<void()> job);
+    // blocks until every submitted job has finished
+    void wait();
+    size_t size() const;
+};